@@ -0,0 +1,123 @@
+#include "assetregistry.h"
+
+#include <tari/datastructures.h>
+#include <tari/memoryhandler.h>
+#include <tari/log.h>
+#include <tari/system.h>
+
+#include "prefetch.h"
+
+typedef struct {
+	int mReferenceCount;
+	TextureData mTexture;
+} TextureEntry;
+
+typedef struct {
+	int mReferenceCount;
+	MugenSpriteFile mSprites;
+} SpriteFileEntry;
+
+typedef struct {
+	int mReferenceCount;
+	MugenAnimations mAnimations;
+} AnimationFileEntry;
+
+static struct {
+	StringMap mTextures;
+	StringMap mSpriteFiles;
+	StringMap mAnimationFiles;
+} gData;
+
+void resetAssetRegistry()
+{
+	// the previous screen's memory stack already took the entries with it
+	gData.mTextures = new_string_map();
+	gData.mSpriteFiles = new_string_map();
+	gData.mAnimationFiles = new_string_map();
+}
+
+static void* getAssetEntryToRelease(StringMap* tMap, char* tPath) {
+	if (!string_map_contains(tMap, tPath)) {
+		logError("Releasing asset that was never acquired");
+		logErrorString(tPath);
+		abortSystem();
+	}
+
+	return string_map_get(tMap, tPath);
+}
+
+TextureData acquireTexture(char* tPath)
+{
+	if (string_map_contains(&gData.mTextures, tPath)) {
+		TextureEntry* e = string_map_get(&gData.mTextures, tPath);
+		e->mReferenceCount++;
+		return e->mTexture;
+	}
+
+	TextureEntry* e = allocMemory(sizeof(TextureEntry));
+	e->mReferenceCount = 1;
+	e->mTexture = loadTexture(tPath);
+	string_map_push_owned(&gData.mTextures, tPath, e);
+	return e->mTexture;
+}
+
+void releaseTexture(char* tPath)
+{
+	TextureEntry* e = getAssetEntryToRelease(&gData.mTextures, tPath);
+	if (--e->mReferenceCount) return;
+
+	unloadTexture(e->mTexture);
+	string_map_remove(&gData.mTextures, tPath);
+}
+
+MugenSpriteFile acquireMugenSpriteFileWithoutPalette(char* tPath)
+{
+	if (string_map_contains(&gData.mSpriteFiles, tPath)) {
+		SpriteFileEntry* e = string_map_get(&gData.mSpriteFiles, tPath);
+		e->mReferenceCount++;
+		return e->mSprites;
+	}
+
+	char loadPath[1024];
+	getPrefetchedFilePath(loadPath, tPath);
+	SpriteFileEntry* e = allocMemory(sizeof(SpriteFileEntry));
+	e->mReferenceCount = 1;
+	e->mSprites = loadMugenSpriteFileWithoutPalette(loadPath);
+	string_map_push_owned(&gData.mSpriteFiles, tPath, e);
+	return e->mSprites;
+}
+
+void releaseMugenSpriteFile(char* tPath)
+{
+	SpriteFileEntry* e = getAssetEntryToRelease(&gData.mSpriteFiles, tPath);
+	if (--e->mReferenceCount) return;
+
+	unloadMugenSpriteFile(&e->mSprites);
+	string_map_remove(&gData.mSpriteFiles, tPath);
+}
+
+MugenAnimations acquireMugenAnimationFile(char* tPath)
+{
+	if (string_map_contains(&gData.mAnimationFiles, tPath)) {
+		AnimationFileEntry* e = string_map_get(&gData.mAnimationFiles, tPath);
+		e->mReferenceCount++;
+		return e->mAnimations;
+	}
+
+	char loadPath[1024];
+	getPrefetchedFilePath(loadPath, tPath);
+	AnimationFileEntry* e = allocMemory(sizeof(AnimationFileEntry));
+	e->mReferenceCount = 1;
+	e->mAnimations = loadMugenAnimationFile(loadPath);
+	string_map_push_owned(&gData.mAnimationFiles, tPath, e);
+	return e->mAnimations;
+}
+
+void releaseMugenAnimationFile(char* tPath)
+{
+	AnimationFileEntry* e = getAssetEntryToRelease(&gData.mAnimationFiles, tPath);
+	if (--e->mReferenceCount) return;
+
+	unloadMugenAnimationFile(&e->mAnimations);
+	string_map_remove(&gData.mAnimationFiles, tPath);
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <tari/animation.h>
+#include <tari/mugenspritefilereader.h>
+#include <tari/mugenanimationreader.h>
+
+void resetAssetRegistry();
+
+TextureData acquireTexture(char* tPath);
+void releaseTexture(char* tPath);
+MugenSpriteFile acquireMugenSpriteFileWithoutPalette(char* tPath);
+void releaseMugenSpriteFile(char* tPath);
+MugenAnimations acquireMugenAnimationFile(char* tPath);
+void releaseMugenAnimationFile(char* tPath);
@@ -11,6 +11,7 @@
 #include "enemyhandler.h"
 #include "player.h"
 #include "level.h"
+#include "compiledassignment.h"
 
 static struct {
 	int mRand1;
@@ -18,12 +19,14 @@ static struct {
 } gData;
 
 static void loadGameAssignments();
+static void loadCompiledGameAssignments();
 
 static void loadAssignmentHandler(void* tData) {
 	(void)tData;
 	gData.mRand1 = 0;
 	gData.mRand2 = 0;
 	loadGameAssignments();
+	loadCompiledGameAssignments();
 }
 
 static void updateAssignmentHandler(void* tData) {
@@ -103,13 +106,6 @@ static void loadGameAssignments()
 	addMugenAssignmentVariable("localbombcount", getLocalBombCountVariable);
 	addMugenAssignmentVariable("stageparttime", fetchStagePartTime);
 	
-	addMugenAssignmentVariable("bigbang", evaluateBigBangFunction);
-	addMugenAssignmentVariable("bounce", evaluateBounceFunction); 
-	addMugenAssignmentVariable("ackermann", evaluateAckermannFunction);
-	addMugenAssignmentVariable("groovy", evaluateSwirlFunction);
-	addMugenAssignmentVariable("blam", evaluateBlamFunction);
-	addMugenAssignmentVariable("transience", evaluateTransienceFunction);
-
 
 	addMugenAssignmentVariable("textaid", evaluateTextAidFunction);
 
@@ -118,3 +114,68 @@ static void loadGameAssignments()
 	addMugenAssignmentArray("identity", fetchIdentity);
 	
 }
+
+static double evaluateRand1(void* tCaller) {
+	(void)tCaller;
+	return gData.mRand1;
+}
+
+static double evaluateRand2(void* tCaller) {
+	(void)tCaller;
+	return gData.mRand2;
+}
+
+static double evaluateBossTime(void* tCaller) {
+	(void)tCaller;
+	return getBossTime();
+}
+
+static double evaluateLocalDeathCount(void* tCaller) {
+	(void)tCaller;
+	return getLocalDeathCount();
+}
+
+static double evaluateLocalBombCount(void* tCaller) {
+	(void)tCaller;
+	return getLocalBombCount();
+}
+
+static double evaluateStagePartTime(void* tCaller) {
+	(void)tCaller;
+	return getStagePartTime();
+}
+
+static double evaluateTextAid(void* tCaller) {
+	(void)tCaller;
+	return getBossAidTextDirection();
+}
+
+static double evaluateRandFrom(double a, double b) {
+	return randfrom(a, b);
+}
+
+static double evaluateRandFromInteger(double a, double b) {
+	return randfromInteger((int)a, (int)b);
+}
+
+static void loadCompiledGameAssignments()
+{
+	resetCompiledAssignmentContext();
+
+	addCompiledAssignmentConstant("pi", 3.14159, 0);
+	addCompiledAssignmentConstant("inf", INF, 1);
+
+	addCompiledAssignmentVariable("rand1", evaluateRand1, 1, COMPILED_ASSIGNMENT_DEPENDENCY_RANDOM);
+	addCompiledAssignmentVariable("rand2", evaluateRand2, 1, COMPILED_ASSIGNMENT_DEPENDENCY_RANDOM);
+	addCompiledAssignmentVariable("bosstime", evaluateBossTime, 0, COMPILED_ASSIGNMENT_DEPENDENCY_STATE);
+	addCompiledAssignmentVariable("angletowardsplayer", getShotAngleTowardsPlayerValue, 0, COMPILED_ASSIGNMENT_DEPENDENCY_STATE);
+	addCompiledAssignmentVariable("curenemy", getCurrentEnemyIndexValue, 1, COMPILED_ASSIGNMENT_DEPENDENCY_ENEMY_INDEX);
+	addCompiledAssignmentVariable("cursubshot", getCurrentSubShotIndexValue, 1, COMPILED_ASSIGNMENT_DEPENDENCY_INDEX);
+	addCompiledAssignmentVariable("localdeathcount", evaluateLocalDeathCount, 1, COMPILED_ASSIGNMENT_DEPENDENCY_STATE);
+	addCompiledAssignmentVariable("localbombcount", evaluateLocalBombCount, 1, COMPILED_ASSIGNMENT_DEPENDENCY_STATE);
+	addCompiledAssignmentVariable("stageparttime", evaluateStagePartTime, 1, COMPILED_ASSIGNMENT_DEPENDENCY_STATE);
+	addCompiledAssignmentVariable("textaid", evaluateTextAid, 1, COMPILED_ASSIGNMENT_DEPENDENCY_STATE);
+
+	addCompiledAssignmentArray("randfrom", evaluateRandFrom, 0, COMPILED_ASSIGNMENT_DEPENDENCY_RANDOM);
+	addCompiledAssignmentArray("randfrominteger", evaluateRandFromInteger, 1, COMPILED_ASSIGNMENT_DEPENDENCY_RANDOM);
+}
@@ -6,6 +6,8 @@
 #include <tari/animation.h>
 #include <tari/wrapper.h>
 
+#include "assetregistry.h"
+
 typedef struct {
 	Position mPosition;
 	Position mOffset;
@@ -32,7 +34,7 @@ static void loadBackgroundHandler(void* tData) {
 	// TODO
 	gData.mElements = new_vector();
 
-	gData.mWhiteTexture = loadTexture("$/rd/effects/white.pkg");
+	gData.mWhiteTexture = acquireTexture("$/rd/effects/white.pkg");
 	gData.mBlackAnimationID = playOneFrameAnimationLoop(makePosition(0, 0, 6), &gData.mWhiteTexture);
 	setAnimationSize(gData.mBlackAnimationID, makePosition(640, 480, 1), makePosition(0, 0, 0));
 	setAnimationColor(gData.mBlackAnimationID, 0, 0, 0);
@@ -80,6 +82,18 @@ void setBackground(char* tPath, MugenSpriteFile* tSprites) {
 	unloadMugenDefScript(script);
 }
 
+static void unloadSingleBackgroundElement(void* tCaller, void* tData) {
+	(void)tCaller;
+	BackgroundElement* e = tData;
+	removeMugenAnimation(e->mAnimationID);
+}
+
+void unloadBackground() {
+	vector_map(&gData.mElements, unloadSingleBackgroundElement, NULL);
+	delete_vector(&gData.mElements);
+	gData.mElements = new_vector();
+}
+
 static void updatePosition() {
 	if (isWrapperPaused()) return;
 
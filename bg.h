@@ -5,4 +5,5 @@
 
 extern ActorBlueprint BackgroundHandler;
 
-void setBackground(char* tPath, MugenSpriteFile* tSprites);
\ No newline at end of file
+void setBackground(char* tPath, MugenSpriteFile* tSprites);
+void unloadBackground();
\ No newline at end of file
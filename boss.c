@@ -1,6 +1,7 @@
 #include "boss.h"
 
 #include <assert.h>
+#include <string.h>
 
 #include <tari/mugenanimationhandler.h>
 #include <tari/mugendefreader.h>
@@ -22,6 +23,10 @@
 #include "level.h"
 #include "player.h"
 #include "storyscreen.h"
+#include "compiledassignment.h"
+#include "bundle.h"
+#include "prefetch.h"
+#include "assetregistry.h"
 
 typedef enum {
 	BOSS_ACTION_TYPE_GOTO,
@@ -41,8 +46,8 @@ typedef enum {
 
 
 typedef struct {
-	MugenAssignment* mTarget;
-	MugenAssignment* mSpeed;
+	CompiledAssignment* mTarget;
+	CompiledAssignment* mSpeed;
 	
 } GotoAction;
 
@@ -52,25 +57,50 @@ typedef struct {
 
 typedef struct {
 	int mIsTimeBased;
-	MugenAssignment* mTime;
+	CompiledAssignment* mTime;
 	int mIsRepeating;
-	MugenAssignment* mRepeatTime;
+	CompiledAssignment* mRepeatTime;
 
 	int mIsHealthBased;
-	MugenAssignment* mHealth;
+	CompiledAssignment* mHealth;
 
 	BossActionType mType;
 	void* mData;
 } BossAction;
 
+typedef struct {
+	Duration mTime;
+	int mOrder;
+	BossAction* mAction;
+} BossTimeTrigger;
+
+typedef struct {
+	int mHealth;
+	int mOrder;
+	BossAction* mAction;
+} BossHealthTrigger;
+
+typedef struct {
+	int mTimeTriggerAmount;
+	BossTimeTrigger* mTimeTriggers;
+
+	int mHealthTriggerAmount;
+	int mHealthTriggerCursor;
+	int mHasPendingHealthTriggers;
+	BossHealthTrigger* mHealthTriggers;
+} BossActionSchedule;
+
 typedef struct {
 	int mLifeStart;
+	int mClearsShots;
+	int mConvertsShotsToItems;
+	int mPeakSubShotAmount;
 
 	Vector mActions;
 } BossPattern;
 
 typedef struct {
-	MugenAssignment* mValue;
+	CompiledAssignment* mValue;
 } SingleValueAction;
 
 typedef enum {
@@ -79,6 +109,22 @@ typedef enum {
 	AID_TEXT_MID,
 } AidTextDirection;
 
+typedef struct {
+	int mIsActive;
+	int mCurrentPattern;
+	int mLife;
+	Duration mTime;
+	Vector3D mTarget;
+	double mSpeed;
+	double mRotation;
+	int mIsFinalBoss;
+	int mIsInvincible;
+	AidTextDirection mAidTextDirection;
+
+	PhysicsObject mPhysics;
+	BossActionSchedule mSchedule;
+} BossCheckpoint;
+
 static struct {
 	int mIsActive;
 	int mIsLoaded;
@@ -97,12 +143,15 @@ static struct {
 	CollisionData mCollisionData;
 
 	Vector mPatterns;
+	BossActionSchedule mSchedule;
 
 	int mCurrentPattern;
+	int mPrewarmedPattern;
 	Duration mTime;
 	Vector3D mTarget;
 
 	Position mHealthBarPosition;
+	int mHealthBarShadowTextID;
 	int mHealthBarTextID;
 	TextureData mHealthBarTexture;
 	int mHealthBarAnimationID;
@@ -116,14 +165,17 @@ static struct {
 	int mIsInvincible;
 
 	AidTextDirection mAidTextDirection;
+
+	BossCheckpoint mCheckpoint;
 } gData;
 
 static void loadBossHandler(void* tData) {
 	(void)tData;
 	gData.mIsActive = 0;
 	gData.mIsLoaded = 0;
+	gData.mName = NULL;
 
-	gData.mHealthBarTexture = loadTexture("$/rd/effects/white.pkg");
+	gData.mHealthBarTexture = acquireTexture("$/rd/effects/white.pkg");
 
 	gData.mIsFinalBoss = 0;
 }
@@ -146,6 +198,8 @@ static int isNewPattern(MugenDefScriptGroup* tGroup) {
 static void loadNewPattern(MugenDefScriptGroup* tGroup) {
 	BossPattern* e = allocMemory(sizeof(BossPattern));
 	e->mLifeStart = getMugenDefIntegerOrDefaultAsGroup(tGroup, "lifestart", gData.mLifeMax);
+	e->mClearsShots = getMugenDefIntegerOrDefaultAsGroup(tGroup, "clearshots", 0);
+	e->mConvertsShotsToItems = getMugenDefIntegerOrDefaultAsGroup(tGroup, "shotstoitems", 0);
 	e->mActions = new_vector();
 
 	vector_push_back_owned(&gData.mPatterns, e);
@@ -157,8 +211,8 @@ static int isAction(MugenDefScriptGroup* tGroup) {
 
 static void loadGotoAction(BossAction* tAction, MugenDefScriptGroup* tGroup) {
 	GotoAction* e = allocMemory(sizeof(GotoAction));
-	fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString("value", tGroup, &e->mTarget, "");
-	fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString("speed", tGroup, &e->mSpeed, "");
+	fetchCompiledAssignmentFromGroupAndReturnWhetherItExistsDefaultString("value", tGroup, &e->mTarget, "");
+	fetchCompiledAssignmentFromGroupAndReturnWhetherItExistsDefaultString("speed", tGroup, &e->mSpeed, "");
 	tAction->mData = e;
 }
 
@@ -171,7 +225,7 @@ static void loadShotAction(BossAction* tAction, MugenDefScriptGroup* tGroup) {
 
 static void loadSingleValueAction(BossAction* tAction, MugenDefScriptGroup* tGroup) {
 	SingleValueAction* e = allocMemory(sizeof(SingleValueAction));
-	fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString("value", tGroup, &e->mValue, "");
+	fetchCompiledAssignmentFromGroupAndReturnWhetherItExistsDefaultString("value", tGroup, &e->mValue, "");
 	tAction->mData = e;
 }
 
@@ -240,10 +294,10 @@ static void loadActionType(BossAction* e, MugenDefScriptGroup* tGroup) {
 
 static void loadAction(MugenDefScriptGroup* tGroup) {
 	BossAction* e = allocMemory(sizeof(BossAction));
-	e->mIsTimeBased = fetchMugenAssignmentFromGroupAndReturnWhetherItExists("time", tGroup, &e->mTime);
-	e->mIsHealthBased = fetchMugenAssignmentFromGroupAndReturnWhetherItExists("health", tGroup, &e->mHealth);
+	e->mIsTimeBased = fetchCompiledAssignmentFromGroupAndReturnWhetherItExists("time", tGroup, &e->mTime);
+	e->mIsHealthBased = fetchCompiledAssignmentFromGroupAndReturnWhetherItExists("health", tGroup, &e->mHealth);
 	assert(e->mIsTimeBased ^ e->mIsHealthBased);
-	e->mIsRepeating= fetchMugenAssignmentFromGroupAndReturnWhetherItExists("timerepeated", tGroup, &e->mRepeatTime);
+	e->mIsRepeating= fetchCompiledAssignmentFromGroupAndReturnWhetherItExists("timerepeated", tGroup, &e->mRepeatTime);
 
 	loadActionType(e, tGroup);
 
@@ -253,11 +307,126 @@ static void loadAction(MugenDefScriptGroup* tGroup) {
 	vector_push_back_owned(&pattern->mActions, e);
 }
 
-void loadBossFromDefinitionPath(char * tDefinitionPath, MugenAnimations* tAnimations, MugenSpriteFile* tSprites)
-{
-	gData.mPatterns = new_vector();
+static void writeActionDataToBundle(BundleWriter* tWriter, BossAction* e) {
+	if (e->mType == BOSS_ACTION_TYPE_GOTO) {
+		GotoAction* data = e->mData;
+		writeCompiledAssignmentToBundle(tWriter, data->mTarget);
+		writeCompiledAssignmentToBundle(tWriter, data->mSpeed);
+	}
+	else if (e->mType == BOSS_ACTION_TYPE_SHOT) {
+		ShotAction* data = e->mData;
+		writeBundleInteger(tWriter, data->mShotID);
+	}
+	else {
+		SingleValueAction* data = e->mData;
+		writeCompiledAssignmentToBundle(tWriter, data->mValue);
+	}
+}
+
+static void readActionDataFromBundle(BundleReader* tReader, BossAction* e) {
+	if (e->mType == BOSS_ACTION_TYPE_GOTO) {
+		GotoAction* data = allocMemory(sizeof(GotoAction));
+		data->mTarget = readCompiledAssignmentFromBundle(tReader);
+		data->mSpeed = readCompiledAssignmentFromBundle(tReader);
+		e->mData = data;
+	}
+	else if (e->mType == BOSS_ACTION_TYPE_SHOT) {
+		ShotAction* data = allocMemory(sizeof(ShotAction));
+		data->mShotID = readBundleInteger(tReader);
+		e->mData = data;
+	}
+	else {
+		SingleValueAction* data = allocMemory(sizeof(SingleValueAction));
+		data->mValue = readCompiledAssignmentFromBundle(tReader);
+		e->mData = data;
+	}
+}
+
+static void writeBossBundle(char* tDefinitionPath, char* tBundlePath) {
+	BundleWriter writer;
+	openBundleForWriting(&writer, "boss", tDefinitionPath);
+	writeBundleString(&writer, gData.mName ? gData.mName : "");
+	writeBundleInteger(&writer, gData.mLifeMax);
+	writeBundleVector3D(&writer, gData.mStartPosition);
+	writeBundleInteger(&writer, gData.mIdleAnimationNumber);
+
+	writeBundleInteger(&writer, vector_size(&gData.mPatterns));
+	int i, j;
+	for (i = 0; i < vector_size(&gData.mPatterns); i++) {
+		BossPattern* pattern = vector_get(&gData.mPatterns, i);
+		writeBundleInteger(&writer, pattern->mLifeStart);
+		writeBundleInteger(&writer, pattern->mClearsShots);
+		writeBundleInteger(&writer, pattern->mConvertsShotsToItems);
+		writeBundleInteger(&writer, vector_size(&pattern->mActions));
+		for (j = 0; j < vector_size(&pattern->mActions); j++) {
+			BossAction* e = vector_get(&pattern->mActions, j);
+			writeBundleInteger(&writer, e->mIsTimeBased);
+			writeCompiledAssignmentToBundle(&writer, e->mTime);
+			writeBundleInteger(&writer, e->mIsHealthBased);
+			writeCompiledAssignmentToBundle(&writer, e->mHealth);
+			writeBundleInteger(&writer, e->mIsRepeating);
+			writeCompiledAssignmentToBundle(&writer, e->mRepeatTime);
+			writeBundleInteger(&writer, e->mType);
+			writeActionDataToBundle(&writer, e);
+		}
+	}
+
+	saveBundleAndClose(&writer, tBundlePath);
+}
+
+static void readBossPatternFromBundle(BundleReader* tReader) {
+	BossPattern* pattern = allocMemory(sizeof(BossPattern));
+	pattern->mLifeStart = readBundleInteger(tReader);
+	pattern->mClearsShots = readBundleInteger(tReader);
+	pattern->mConvertsShotsToItems = readBundleInteger(tReader);
+	pattern->mActions = new_vector();
+	vector_push_back_owned(&gData.mPatterns, pattern);
+
+	int amount = readBundleInteger(tReader);
+	int i;
+	for (i = 0; i < amount && !tReader->mHasFailed; i++) {
+		BossAction* e = allocMemory(sizeof(BossAction));
+		e->mIsTimeBased = readBundleInteger(tReader);
+		e->mTime = readCompiledAssignmentFromBundle(tReader);
+		e->mIsHealthBased = readBundleInteger(tReader);
+		e->mHealth = readCompiledAssignmentFromBundle(tReader);
+		e->mIsRepeating = readBundleInteger(tReader);
+		e->mRepeatTime = readCompiledAssignmentFromBundle(tReader);
+		e->mType = readBundleInteger(tReader);
+		readActionDataFromBundle(tReader, e);
+
+		vector_push_back_owned(&pattern->mActions, e);
+	}
+}
+
+static int loadBossFromBundle(char* tDefinitionPath, char* tBundlePath) {
+	BundleReader reader;
+	if (!openBundleForReading(&reader, tBundlePath, "boss", tDefinitionPath)) return 0;
 
-	MugenDefScript script = loadMugenDefScript(tDefinitionPath);
+	gData.mName = readAllocatedBundleString(&reader);
+	gData.mLifeMax = readBundleInteger(&reader);
+	gData.mStartPosition = readBundleVector3D(&reader);
+	gData.mIdleAnimationNumber = readBundleInteger(&reader);
+
+	int amount = readBundleInteger(&reader);
+	int i;
+	for (i = 0; i < amount && !reader.mHasFailed; i++) {
+		readBossPatternFromBundle(&reader);
+	}
+
+	if (!closeBundleAndReturnWhetherItWasValid(&reader)) {
+		logError("Corrupt boss bundle");
+		logErrorString(tBundlePath);
+		abortSystem();
+	}
+
+	return 1;
+}
+
+static void loadBossFromDefinitionFile(char* tDefinitionPath, char* tBundlePath) {
+	char loadPath[1024];
+	getPrefetchedFilePath(loadPath, tDefinitionPath);
+	MugenDefScript script = loadMugenDefScript(loadPath);
 	resetMugenScriptParser();
 	addMugenScriptParseFunction(isHeader, loadHeader);
 	addMugenScriptParseFunction(isNewPattern, loadNewPattern);
@@ -266,6 +435,61 @@ void loadBossFromDefinitionPath(char * tDefinitionPath, MugenAnimations* tAnimat
 
 	unloadMugenDefScript(script);
 
+	if (isBundleCompilationActive()) {
+		writeBossBundle(tDefinitionPath, tBundlePath);
+	}
+}
+
+static void loadBossActionSchedule() {
+	int maxActionAmount = 1;
+	int i;
+	for (i = 0; i < vector_size(&gData.mPatterns); i++) {
+		BossPattern* pattern = vector_get(&gData.mPatterns, i);
+		maxActionAmount = max(maxActionAmount, vector_size(&pattern->mActions));
+	}
+
+	gData.mSchedule.mTimeTriggers = allocMemory(sizeof(BossTimeTrigger) * maxActionAmount);
+	gData.mSchedule.mHealthTriggers = allocMemory(sizeof(BossHealthTrigger) * maxActionAmount);
+	gData.mSchedule.mTimeTriggerAmount = 0;
+	gData.mSchedule.mHealthTriggerAmount = 0;
+	gData.mSchedule.mHealthTriggerCursor = 0;
+	gData.mSchedule.mHasPendingHealthTriggers = 0;
+
+	gData.mCheckpoint.mSchedule.mTimeTriggers = allocMemory(sizeof(BossTimeTrigger) * maxActionAmount);
+	gData.mCheckpoint.mSchedule.mHealthTriggers = allocMemory(sizeof(BossHealthTrigger) * maxActionAmount);
+	gData.mCheckpoint.mIsActive = 0;
+}
+
+static void estimateBossPatternSubShotAmounts() {
+	int i;
+	for (i = 0; i < vector_size(&gData.mPatterns); i++) {
+		BossPattern* pattern = vector_get(&gData.mPatterns, i);
+		pattern->mPeakSubShotAmount = 0;
+
+		// every shot action of the pattern firing at once is the worst case
+		int j;
+		for (j = 0; j < vector_size(&pattern->mActions); j++) {
+			BossAction* e = vector_get(&pattern->mActions, j);
+			if (e->mType != BOSS_ACTION_TYPE_SHOT) continue;
+			ShotAction* shot = e->mData;
+			pattern->mPeakSubShotAmount += getShotSubShotAmountEstimate(shot->mShotID);
+		}
+	}
+}
+
+void loadBossFromDefinitionPath(char * tDefinitionPath, MugenAnimations* tAnimations, MugenSpriteFile* tSprites)
+{
+	gData.mPatterns = new_vector();
+
+	char bundlePath[1024];
+	getBundlePathFromDefinitionPath(bundlePath, tDefinitionPath);
+	if (!loadBossFromBundle(tDefinitionPath, bundlePath)) {
+		loadBossFromDefinitionFile(tDefinitionPath, bundlePath);
+	}
+
+	loadBossActionSchedule();
+	estimateBossPatternSubShotAmounts();
+
 	gData.mAnimations = tAnimations;
 	gData.mIdleAnimation = getMugenAnimation(tAnimations, gData.mIdleAnimationNumber);
 	gData.mSprites = tSprites;
@@ -275,6 +499,64 @@ void loadBossFromDefinitionPath(char * tDefinitionPath, MugenAnimations* tAnimat
 	gData.mIsLoaded = 1;
 }
 
+static void unloadBossActionData(BossAction* e) {
+	if (e->mType == BOSS_ACTION_TYPE_GOTO) {
+		GotoAction* data = e->mData;
+		destroyCompiledAssignment(data->mTarget);
+		destroyCompiledAssignment(data->mSpeed);
+	}
+	else if (e->mType != BOSS_ACTION_TYPE_SHOT) {
+		SingleValueAction* data = e->mData;
+		destroyCompiledAssignment(data->mValue);
+	}
+	freeMemory(e->mData);
+}
+
+static void unloadBossPattern(BossPattern* tPattern) {
+	int i;
+	for (i = 0; i < vector_size(&tPattern->mActions); i++) {
+		BossAction* e = vector_get(&tPattern->mActions, i);
+		destroyCompiledAssignment(e->mTime);
+		destroyCompiledAssignment(e->mHealth);
+		destroyCompiledAssignment(e->mRepeatTime);
+		unloadBossActionData(e);
+	}
+	delete_vector(&tPattern->mActions);
+}
+
+static void removeBossDisplay() {
+	removeMugenAnimation(gData.mAnimationID);
+	removeFromPhysicsHandler(gData.mPhysicsID);
+	removeHandledText(gData.mHealthBarShadowTextID);
+	removeHandledText(gData.mHealthBarTextID);
+	removeHandledAnimation(gData.mHealthBarAnimationID);
+}
+
+void unloadBoss()
+{
+	if (gData.mIsActive) {
+		removeBossDisplay();
+		reserveEnemySubShots(0);
+		gData.mIsActive = 0;
+	}
+
+	if (gData.mIsLoaded) {
+		int i;
+		for (i = 0; i < vector_size(&gData.mPatterns); i++) {
+			unloadBossPattern(vector_get(&gData.mPatterns, i));
+		}
+		delete_vector(&gData.mPatterns);
+		freeMemory(gData.mSchedule.mTimeTriggers);
+		freeMemory(gData.mSchedule.mHealthTriggers);
+		freeMemory(gData.mCheckpoint.mSchedule.mTimeTriggers);
+		freeMemory(gData.mCheckpoint.mSchedule.mHealthTriggers);
+		gData.mCheckpoint.mIsActive = 0;
+		if (gData.mName) freeMemory(gData.mName);
+		gData.mName = NULL;
+		gData.mIsLoaded = 0;
+	}
+}
+
 static void updateHealthBarSize() {
 	double start = gData.mHealthBarPosition.x;
 	double end = 620;
@@ -308,42 +590,61 @@ static void setBossDefeated() {
 	}
 }
 
-static void bossHitCB(void* tCaller, void* tCollisionData) {
-	(void)tCaller;
-	(void)tCollisionData;
+static void checkBossHealthTriggers() {
+	BossActionSchedule* schedule = &gData.mSchedule;
+	if (schedule->mHealthTriggerCursor >= schedule->mHealthTriggerAmount) return;
+
+	if (gData.mLife < schedule->mHealthTriggers[schedule->mHealthTriggerCursor].mHealth) {
+		schedule->mHasPendingHealthTriggers = 1;
+	}
+}
 
+static void damageBoss() {
 	if (gData.mIsDefeated) return;
 	if (gData.mIsInvincible) return;
 
 	gData.mLife--;
 	updateHealthBarSize();
+	checkBossHealthTriggers();
 
 	if (gData.mLife <= 0) {
 		setBossDefeated();
 	}
 }
 
-void activateBoss() {
+static void bossHitCB(void* tCaller, void* tCollisionData) {
+	(void)tCaller;
+	(void)tCollisionData;
+	damageBoss();
+}
+
+static void scheduleBossPattern(int tPattern);
+
+static void addBossDisplay() {
 	gData.mPhysicsID = addToPhysicsHandler(gData.mStartPosition);
 
 	gData.mAnimationID = addMugenAnimation(gData.mIdleAnimation, gData.mSprites, makePosition(0, 0, 15));
 	setMugenAnimationBasePosition(gData.mAnimationID, getHandledPhysicsPositionReference(gData.mPhysicsID));
 	setMugenAnimationCollisionActive(gData.mAnimationID, getEnemyCollisionList(), bossHitCB, NULL, &gData.mCollisionData);
 
-	gData.mTime = 0;
-	gData.mCurrentPattern = 0;
-	gData.mLife = gData.mLifeMax;
-	gData.mTarget = *getHandledPhysicsPositionReference(gData.mPhysicsID);
-	gData.mSpeed = 0;
-	gData.mRotation = 0;
-
 	char bossText[100];
 	sprintf(bossText, "%s", gData.mName);
-	gData.mHealthBarTextID = addHandledText(makePosition(21, 21, 80), bossText, 0, COLOR_BLACK, makePosition(15, 15, 0), makePosition(-2, -2, 1), makePosition(INF, INF, INF), INF);
+	gData.mHealthBarShadowTextID = addHandledText(makePosition(21, 21, 80), bossText, 0, COLOR_BLACK, makePosition(15, 15, 0), makePosition(-2, -2, 1), makePosition(INF, INF, INF), INF);
 	gData.mHealthBarTextID = addHandledText(makePosition(20, 20, 81), bossText, 0, COLOR_WHITE, makePosition(15, 15, 0), makePosition(-2, -2, 1), makePosition(INF, INF, INF), INF);
 	gData.mHealthBarPosition = makePosition(strlen(bossText)*(15-2)+32, 22, 80);
 	gData.mHealthBarAnimationID = playOneFrameAnimationLoop(gData.mHealthBarPosition, &gData.mHealthBarTexture);
 	setAnimationColorType(gData.mHealthBarAnimationID, COLOR_DARK_RED);
+}
+
+void activateBoss() {
+	addBossDisplay();
+
+	gData.mTime = 0;
+	gData.mCurrentPattern = 0;
+	gData.mLife = gData.mLifeMax;
+	gData.mTarget = *getHandledPhysicsPositionReference(gData.mPhysicsID);
+	gData.mSpeed = 0;
+	gData.mRotation = 0;
 	updateHealthBarSize();
 
 	gData.mIsFinalBoss = 0;
@@ -351,6 +652,70 @@ void activateBoss() {
 
 	gData.mIsDefeated = 0;
 	gData.mIsActive = 1;
+	gData.mPrewarmedPattern = 0;
+	scheduleBossPattern(gData.mCurrentPattern);
+	prefetchNextLevel();
+}
+
+static void copyBossActionSchedule(BossActionSchedule* tDst, BossActionSchedule* tSrc) {
+	tDst->mTimeTriggerAmount = tSrc->mTimeTriggerAmount;
+	tDst->mHealthTriggerAmount = tSrc->mHealthTriggerAmount;
+	tDst->mHealthTriggerCursor = tSrc->mHealthTriggerCursor;
+	tDst->mHasPendingHealthTriggers = tSrc->mHasPendingHealthTriggers;
+	memcpy(tDst->mTimeTriggers, tSrc->mTimeTriggers, sizeof(BossTimeTrigger) * tSrc->mTimeTriggerAmount);
+	memcpy(tDst->mHealthTriggers, tSrc->mHealthTriggers, sizeof(BossHealthTrigger) * tSrc->mHealthTriggerAmount);
+}
+
+void saveBossCheckpoint()
+{
+	BossCheckpoint* e = &gData.mCheckpoint;
+	e->mIsActive = gData.mIsActive && !gData.mIsDefeated;
+	if (!e->mIsActive) return;
+
+	e->mCurrentPattern = gData.mCurrentPattern;
+	e->mLife = gData.mLife;
+	e->mTime = gData.mTime;
+	e->mTarget = gData.mTarget;
+	e->mSpeed = gData.mSpeed;
+	e->mRotation = gData.mRotation;
+	e->mIsFinalBoss = gData.mIsFinalBoss;
+	e->mIsInvincible = gData.mIsInvincible;
+	e->mAidTextDirection = gData.mAidTextDirection;
+	e->mPhysics = *getPhysicsFromHandler(gData.mPhysicsID);
+	copyBossActionSchedule(&e->mSchedule, &gData.mSchedule);
+}
+
+void restoreBossCheckpoint()
+{
+	if (gData.mIsActive) {
+		removeBossDisplay();
+		gData.mIsActive = 0;
+	}
+	reserveEnemySubShots(0);
+
+	BossCheckpoint* e = &gData.mCheckpoint;
+	if (!e->mIsActive) return;
+
+	addBossDisplay();
+	*getPhysicsFromHandler(gData.mPhysicsID) = e->mPhysics;
+
+	gData.mCurrentPattern = e->mCurrentPattern;
+	gData.mLife = e->mLife;
+	gData.mTime = e->mTime;
+	gData.mTarget = e->mTarget;
+	gData.mSpeed = e->mSpeed;
+	gData.mRotation = e->mRotation;
+	gData.mIsFinalBoss = e->mIsFinalBoss;
+	gData.mIsInvincible = e->mIsInvincible;
+	gData.mAidTextDirection = e->mAidTextDirection;
+	copyBossActionSchedule(&gData.mSchedule, &e->mSchedule);
+
+	setMugenAnimationDrawAngle(gData.mAnimationID, gData.mRotation);
+	updateHealthBarSize();
+
+	gData.mPrewarmedPattern = gData.mCurrentPattern;
+	gData.mIsDefeated = 0;
+	gData.mIsActive = 1;
 }
 
 void fetchBossTimeVariable(char * tDst, void * tCaller)
@@ -359,6 +724,11 @@ void fetchBossTimeVariable(char * tDst, void * tCaller)
 	sprintf(tDst, "%f", gData.mTime);
 }
 
+double getBossTime()
+{
+	return gData.mTime;
+}
+
 int isBossActive()
 {
 	return gData.mIsActive;
@@ -377,6 +747,11 @@ void evaluateTextAidFunction(char * tDst, void * tCaller)
 	sprintf(tDst, "%d", gData.mAidTextDirection);
 }
 
+int getBossAidTextDirection()
+{
+	return gData.mAidTextDirection;
+}
+
 void addFinalBossShot(int mID)
 {
 	if (!gData.mIsFinalBoss) return;
@@ -385,6 +760,23 @@ void addFinalBossShot(int mID)
 	addShot(mID, getEnemyCollisionList(), p);
 }
 
+int isBossInCircle(Position tCenter, double tRadius)
+{
+	if (!gData.mIsActive) return 0;
+
+	Position p = *getHandledPhysicsPositionReference(gData.mPhysicsID);
+	double dx = p.x - tCenter.x;
+	double dy = p.y - tCenter.y;
+	return dx*dx + dy*dy <= tRadius * tRadius;
+}
+
+void damageBossInCircle(Position tCenter, double tRadius)
+{
+	if (!isBossInCircle(tCenter, tRadius)) return;
+
+	damageBoss();
+}
+
 void setFinalBossInvincible()
 {
 	if (!gData.mIsFinalBoss) return;
@@ -398,14 +790,39 @@ void setFinalBossVulnerable()
 }
 
 
+#define BOSS_PATTERN_PREWARM_LIFE_MARGIN 10
+
+static void updatePrewarmingNextPattern(BossPattern* tNextPattern) {
+	if (gData.mPrewarmedPattern > gData.mCurrentPattern) return;
+	if (gData.mLife > tNextPattern->mLifeStart + BOSS_PATTERN_PREWARM_LIFE_MARGIN) return;
+
+	reserveEnemySubShots(tNextPattern->mPeakSubShotAmount);
+	gData.mPrewarmedPattern = gData.mCurrentPattern + 1;
+}
+
+static void clearShotsForPattern(BossPattern* tPattern) {
+	if (!tPattern->mClearsShots) return;
+
+	if (tPattern->mConvertsShotsToItems) {
+		convertEnemyShotsToItems();
+	}
+	else {
+		removeEnemyShots();
+	}
+}
+
 static void updateGoingToNextPattern() {
 	if (gData.mCurrentPattern >= vector_size(&gData.mPatterns) - 1) return;
 
 	BossPattern* nextPattern = vector_get(&gData.mPatterns, gData.mCurrentPattern + 1);
+	updatePrewarmingNextPattern(nextPattern);
 	if (gData.mLife <= nextPattern->mLifeStart) {
 		gData.mLife = nextPattern->mLifeStart;
 		gData.mTime = 0;
 		gData.mCurrentPattern++;
+		clearShotsForPattern(nextPattern);
+		scheduleBossPattern(gData.mCurrentPattern);
+		reserveEnemySubShots(0);
 	}
 }
 
@@ -415,8 +832,8 @@ static void setBossTarget(Vector3D tTarget) {
 
 static void performGoto(BossAction* tAction) {
 	GotoAction* e = tAction->mData;
-	gData.mSpeed = getMugenAssignmentAsFloatValueOrDefaultWhenEmpty(e->mSpeed, NULL, 2);
-	Vector3D target = getMugenAssignmentAsVector3DValueOrDefaultWhenEmpty(e->mTarget, NULL, makePosition(0, 0, 0));
+	gData.mSpeed = getCompiledAssignmentAsFloatValueOrDefaultWhenEmpty(e->mSpeed, NULL, 2);
+	Vector3D target = getCompiledAssignmentAsVector3DValueOrDefaultWhenEmpty(e->mTarget, NULL, makePosition(0, 0, 0));
 
 	setHandledPhysicsMaxVelocity(gData.mPhysicsID, gData.mSpeed);
 	setBossTarget(target);
@@ -432,7 +849,7 @@ static void performSmallPowerDrop(BossAction* tAction) {
 	SingleValueAction* e = tAction->mData;
 
 	Position p = *getHandledPhysicsPositionReference(gData.mPhysicsID);
-	int amount = getMugenAssignmentAsIntegerValueOrDefaultWhenEmpty(e->mValue, NULL, 0);
+	int amount = getCompiledAssignmentAsIntegerValueOrDefaultWhenEmpty(e->mValue, NULL, 0);
 	addSmallPowerItems(p, amount);
 }
 
@@ -440,7 +857,7 @@ static void performLifeDrop(BossAction* tAction) {
 	SingleValueAction* e = tAction->mData;
 
 	Position p = *getHandledPhysicsPositionReference(gData.mPhysicsID);
-	int amount = getMugenAssignmentAsIntegerValueOrDefaultWhenEmpty(e->mValue, NULL, 0);
+	int amount = getCompiledAssignmentAsIntegerValueOrDefaultWhenEmpty(e->mValue, NULL, 0);
 	addLifeItems(p, amount);
 }
 
@@ -448,14 +865,14 @@ static void performBombDrop(BossAction* tAction) {
 	SingleValueAction* e = tAction->mData;
 
 	Position p = *getHandledPhysicsPositionReference(gData.mPhysicsID);
-	int amount = getMugenAssignmentAsIntegerValueOrDefaultWhenEmpty(e->mValue, NULL, 0);
+	int amount = getCompiledAssignmentAsIntegerValueOrDefaultWhenEmpty(e->mValue, NULL, 0);
 	addBombItems(p, amount);
 }
 
 static void performSettingRotation(BossAction* tAction) {
 	SingleValueAction* e = tAction->mData;
 
-	double value = getMugenAssignmentAsFloatValueOrDefaultWhenEmpty(e->mValue, NULL, 0);
+	double value = getCompiledAssignmentAsFloatValueOrDefaultWhenEmpty(e->mValue, NULL, 0);
 	gData.mRotation = value;
 	setMugenAnimationDrawAngle(gData.mAnimationID, gData.mRotation);
 }
@@ -463,7 +880,7 @@ static void performSettingRotation(BossAction* tAction) {
 static void performAddingRotation(BossAction* tAction) {
 	SingleValueAction* e = tAction->mData;
 
-	double value = getMugenAssignmentAsFloatValueOrDefaultWhenEmpty(e->mValue, NULL, 0);
+	double value = getCompiledAssignmentAsFloatValueOrDefaultWhenEmpty(e->mValue, NULL, 0);
 	gData.mRotation += value;
 	setMugenAnimationDrawAngle(gData.mAnimationID, gData.mRotation);
 }
@@ -480,7 +897,7 @@ static void fadeOutOver(void* tCaller) {
 static void performAnimationChange(BossAction* tAction) {
 	SingleValueAction* e = tAction->mData;
 
-	int value = getMugenAssignmentAsIntegerValueOrDefaultWhenEmpty(e->mValue, NULL, 0);
+	int value = getCompiledAssignmentAsIntegerValueOrDefaultWhenEmpty(e->mValue, NULL, 0);
 	changeMugenAnimation(gData.mAnimationID, getMugenAnimation(gData.mAnimations, value));
 }
 
@@ -555,34 +972,121 @@ static void performAction(BossAction* e) {
 	
 }
 
-static void updateSingleAction(void* tCaller, void* tData) {
-	(void)tCaller;
-	BossAction* e = tData;
-	
-	int isTimeTrigger = e->mIsTimeBased && isDurationOver(gData.mTime, evaluateMugenAssignmentAndReturnAsFloat(e->mTime, NULL));
-	if (isTimeTrigger) {
-		if (e->mIsRepeating) {
-			int repeatTime = getMugenAssignmentAsIntegerValueOrDefaultWhenEmpty(e->mRepeatTime, NULL, INF);
-			e->mTime = makeFloatMugenAssignment(gData.mTime + repeatTime);
+static int isBossTimeTriggerBefore(BossTimeTrigger* a, BossTimeTrigger* b) {
+	if (a->mTime != b->mTime) return a->mTime < b->mTime;
+	return a->mOrder < b->mOrder;
+}
+
+static void swapBossTimeTriggers(BossTimeTrigger* a, BossTimeTrigger* b) {
+	BossTimeTrigger tmp = *a;
+	*a = *b;
+	*b = tmp;
+}
+
+static void pushBossTimeTrigger(BossAction* tAction, Duration tTime, int tOrder) {
+	BossActionSchedule* schedule = &gData.mSchedule;
+	int i = schedule->mTimeTriggerAmount++;
+	schedule->mTimeTriggers[i].mTime = tTime;
+	schedule->mTimeTriggers[i].mOrder = tOrder;
+	schedule->mTimeTriggers[i].mAction = tAction;
+
+	while (i > 0) {
+		int parent = (i - 1) / 2;
+		if (!isBossTimeTriggerBefore(&schedule->mTimeTriggers[i], &schedule->mTimeTriggers[parent])) break;
+		swapBossTimeTriggers(&schedule->mTimeTriggers[i], &schedule->mTimeTriggers[parent]);
+		i = parent;
+	}
+}
+
+static BossTimeTrigger popBossTimeTrigger() {
+	BossActionSchedule* schedule = &gData.mSchedule;
+	BossTimeTrigger ret = schedule->mTimeTriggers[0];
+	schedule->mTimeTriggers[0] = schedule->mTimeTriggers[--schedule->mTimeTriggerAmount];
+
+	int i = 0;
+	for (;;) {
+		int smallest = i;
+		int left = 2 * i + 1;
+		int right = 2 * i + 2;
+		if (left < schedule->mTimeTriggerAmount && isBossTimeTriggerBefore(&schedule->mTimeTriggers[left], &schedule->mTimeTriggers[smallest])) smallest = left;
+		if (right < schedule->mTimeTriggerAmount && isBossTimeTriggerBefore(&schedule->mTimeTriggers[right], &schedule->mTimeTriggers[smallest])) smallest = right;
+		if (smallest == i) break;
+		swapBossTimeTriggers(&schedule->mTimeTriggers[i], &schedule->mTimeTriggers[smallest]);
+		i = smallest;
+	}
+
+	return ret;
+}
+
+static void addBossHealthTrigger(BossAction* tAction, int tOrder) {
+	BossActionSchedule* schedule = &gData.mSchedule;
+	BossHealthTrigger e;
+	e.mHealth = evaluateCompiledAssignmentAndReturnAsInteger(tAction->mHealth, NULL);
+	e.mOrder = tOrder;
+	e.mAction = tAction;
+
+	// sorted by descending threshold, since life only goes down within a pattern
+	int i = schedule->mHealthTriggerAmount++;
+	while (i > 0 && schedule->mHealthTriggers[i - 1].mHealth < e.mHealth) {
+		schedule->mHealthTriggers[i] = schedule->mHealthTriggers[i - 1];
+		i--;
+	}
+	schedule->mHealthTriggers[i] = e;
+}
+
+static void scheduleBossPattern(int tPattern) {
+	BossActionSchedule* schedule = &gData.mSchedule;
+	schedule->mTimeTriggerAmount = 0;
+	schedule->mHealthTriggerAmount = 0;
+	schedule->mHealthTriggerCursor = 0;
+
+	BossPattern* pattern = vector_get(&gData.mPatterns, tPattern);
+	int i;
+	for (i = 0; i < vector_size(&pattern->mActions); i++) {
+		BossAction* e = vector_get(&pattern->mActions, i);
+		if (e->mIsTimeBased) {
+			pushBossTimeTrigger(e, evaluateCompiledAssignmentAndReturnAsFloat(e->mTime, NULL), i);
 		}
-		else {
-			e->mTime = makeFloatMugenAssignment(INF);
+		if (e->mIsHealthBased) {
+			addBossHealthTrigger(e, i);
 		}
 	}
 
-	int isHealthTrigger = e->mIsHealthBased && gData.mLife < evaluateMugenAssignmentAndReturnAsInteger(e->mHealth, NULL);
-	if (isHealthTrigger) {
-		e->mHealth = makeNumberMugenAssignment(-1);
-	}
-	
-	if (isTimeTrigger || isHealthTrigger) {
+	checkBossHealthTriggers();
+}
+
+static void updateTimeTriggers() {
+	BossActionSchedule* schedule = &gData.mSchedule;
+	while (schedule->mTimeTriggerAmount && isDurationOver(gData.mTime, schedule->mTimeTriggers[0].mTime)) {
+		BossTimeTrigger trigger = popBossTimeTrigger();
+		BossAction* e = trigger.mAction;
+
+		if (e->mIsRepeating) {
+			int repeatTime = getCompiledAssignmentAsIntegerValueOrDefaultWhenEmpty(e->mRepeatTime, NULL, INF);
+			pushBossTimeTrigger(e, gData.mTime + max(1, repeatTime), trigger.mOrder);
+		}
+
 		performAction(e);
 	}
 }
 
+static void updateHealthTriggers() {
+	BossActionSchedule* schedule = &gData.mSchedule;
+	if (!schedule->mHasPendingHealthTriggers) return;
+	schedule->mHasPendingHealthTriggers = 0;
+
+	while (schedule->mHealthTriggerCursor < schedule->mHealthTriggerAmount) {
+		BossHealthTrigger* trigger = &schedule->mHealthTriggers[schedule->mHealthTriggerCursor];
+		if (gData.mLife >= trigger->mHealth) break;
+
+		schedule->mHealthTriggerCursor++;
+		performAction(trigger->mAction);
+	}
+}
+
 static void updateActions() {
-	BossPattern* pattern = vector_get(&gData.mPatterns, gData.mCurrentPattern);
-	vector_map(&pattern->mActions, updateSingleAction, NULL);
+	updateTimeTriggers();
+	updateHealthTriggers();
 }
 
 static void updateMovement() {
@@ -6,11 +6,18 @@
 extern ActorBlueprint BossHandler;
 void  loadBossFromDefinitionPath(char * tDefinitionPath, MugenAnimations* tAnimations, MugenSpriteFile* tSprites);
 void activateBoss();
+void unloadBoss();
+void saveBossCheckpoint();
+void restoreBossCheckpoint();
 
 void fetchBossTimeVariable(char* tDst, void* tCaller);
+double getBossTime();
 int isBossActive();
 Position getBossPosition();
+int isBossInCircle(Position tCenter, double tRadius);
+void damageBossInCircle(Position tCenter, double tRadius);
 void evaluateTextAidFunction(char * tDst, void * tCaller);
+int getBossAidTextDirection();
 void addFinalBossShot(int mID);
 void setFinalBossInvincible();
 void setFinalBossVulnerable();
@@ -0,0 +1,194 @@
+#include "bundle.h"
+
+#include <string.h>
+#include <fcntl.h>
+
+#include <tari/memoryhandler.h>
+#include <tari/log.h>
+
+#include "prefetch.h"
+
+#define BUNDLE_MAGIC "EOTB"
+
+void getBundlePathFromDefinitionPath(char* tDst, char* tDefinitionPath)
+{
+	strcpy(tDst, tDefinitionPath);
+	char* extension = strrchr(tDst, '.');
+	if (extension && !strchr(extension, '/')) *extension = '\0';
+	strcat(tDst, ".bundle");
+}
+
+int isBundleCompilationActive()
+{
+#if defined(DEVELOP) || defined(BUNDLE_COMPILER)
+	return 1;
+#else
+	return 0;
+#endif
+}
+
+static void readBundleBytes(BundleReader* tReader, void* tDst, uint32_t tSize) {
+	if (tReader->mHasFailed || tReader->mPosition + tSize > tReader->mBuffer.mLength) {
+		tReader->mHasFailed = 1;
+		memset(tDst, 0, tSize);
+		return;
+	}
+
+	memcpy(tDst, tReader->mBuffer.mData + tReader->mPosition, tSize);
+	tReader->mPosition += tSize;
+}
+
+int readBundleInteger(BundleReader* tReader)
+{
+	int32_t value;
+	readBundleBytes(tReader, &value, sizeof(int32_t));
+	return value;
+}
+
+double readBundleFloat(BundleReader* tReader)
+{
+	double value;
+	readBundleBytes(tReader, &value, sizeof(double));
+	return value;
+}
+
+Vector3D readBundleVector3D(BundleReader* tReader)
+{
+	Vector3D ret;
+	ret.x = readBundleFloat(tReader);
+	ret.y = readBundleFloat(tReader);
+	ret.z = readBundleFloat(tReader);
+	return ret;
+}
+
+char* readAllocatedBundleString(BundleReader* tReader)
+{
+	int length = readBundleInteger(tReader);
+	if (length < 0 || tReader->mHasFailed) {
+		tReader->mHasFailed = 1;
+		length = 0;
+	}
+
+	char* ret = allocMemory(length + 1);
+	readBundleBytes(tReader, ret, length);
+	ret[length] = '\0';
+	return ret;
+}
+
+static int getBundleSourceSize(char* tDefinitionPath) {
+	// only the size is compared, reading the whole definition would undo what the bundle saves
+	FileHandler file = fileOpen(tDefinitionPath, O_RDONLY);
+	if (file == FILEHND_INVALID) return -1;
+
+	int size = fileTotal(file);
+	fileClose(file);
+	return size;
+}
+
+int openBundleForReading(BundleReader* oReader, char* tPath, char* tType, char* tDefinitionPath)
+{
+	if (isBundleCompilationActive()) return 0;
+
+	Buffer buffer;
+	if (!adoptPrefetchedFile(tPath, &buffer)) {
+		if (!isFile(tPath)) return 0;
+		buffer = fileToBuffer(tPath);
+	}
+
+	if (!openBundleForReadingFromBuffer(oReader, buffer, tType)) {
+		logWarningFormat("Outdated bundle %s, using text definition.", tPath);
+		return 0;
+	}
+
+	// a bundle shipped without its definition is taken as is
+	int sourceSize = getBundleSourceSize(tDefinitionPath);
+	if (sourceSize >= 0 && oReader->mSourceSize != sourceSize) {
+		logWarningFormat("Bundle %s does not match %s, using text definition.", tPath, tDefinitionPath);
+		freeBuffer(oReader->mBuffer);
+		return 0;
+	}
+
+	return 1;
+}
+
+int openBundleForReadingFromBuffer(BundleReader* oReader, Buffer tBuffer, char* tType)
+{
+	oReader->mBuffer = tBuffer;
+	oReader->mPosition = 0;
+	oReader->mHasFailed = 0;
+
+	char magic[4];
+	readBundleBytes(oReader, magic, sizeof(magic));
+	int version = readBundleInteger(oReader);
+	char* type = readAllocatedBundleString(oReader);
+	oReader->mSourceSize = readBundleInteger(oReader);
+	int isValid = !oReader->mHasFailed && !memcmp(BUNDLE_MAGIC, magic, sizeof(magic)) && version == BUNDLE_VERSION && !strcmp(tType, type);
+	freeMemory(type);
+
+	if (!isValid) {
+		freeBuffer(oReader->mBuffer);
+		return 0;
+	}
+
+	return 1;
+}
+
+int closeBundleAndReturnWhetherItWasValid(BundleReader* tReader)
+{
+	int isValid = !tReader->mHasFailed && tReader->mPosition == tReader->mBuffer.mLength;
+	freeBuffer(tReader->mBuffer);
+	return isValid;
+}
+
+static void writeBundleBytes(BundleWriter* tWriter, void* tData, int tSize) {
+	if (tWriter->mSize + tSize > tWriter->mCapacity) {
+		tWriter->mCapacity = (tWriter->mSize + tSize) * 2;
+		tWriter->mData = reallocMemory(tWriter->mData, tWriter->mCapacity);
+	}
+
+	memcpy(tWriter->mData + tWriter->mSize, tData, tSize);
+	tWriter->mSize += tSize;
+}
+
+void openBundleForWriting(BundleWriter* oWriter, char* tType, char* tDefinitionPath)
+{
+	oWriter->mSize = 0;
+	oWriter->mCapacity = 1024;
+	oWriter->mData = allocMemory(oWriter->mCapacity);
+
+	writeBundleBytes(oWriter, BUNDLE_MAGIC, 4);
+	writeBundleInteger(oWriter, BUNDLE_VERSION);
+	writeBundleString(oWriter, tType);
+	writeBundleInteger(oWriter, getBundleSourceSize(tDefinitionPath));
+}
+
+void saveBundleAndClose(BundleWriter* tWriter, char* tPath)
+{
+	bufferToFile(tPath, makeBuffer(tWriter->mData, tWriter->mSize));
+	freeMemory(tWriter->mData);
+}
+
+void writeBundleInteger(BundleWriter* tWriter, int tValue)
+{
+	int32_t value = tValue;
+	writeBundleBytes(tWriter, &value, sizeof(int32_t));
+}
+
+void writeBundleFloat(BundleWriter* tWriter, double tValue)
+{
+	writeBundleBytes(tWriter, &tValue, sizeof(double));
+}
+
+void writeBundleVector3D(BundleWriter* tWriter, Vector3D tValue)
+{
+	writeBundleFloat(tWriter, tValue.x);
+	writeBundleFloat(tWriter, tValue.y);
+	writeBundleFloat(tWriter, tValue.z);
+}
+
+void writeBundleString(BundleWriter* tWriter, char* tValue)
+{
+	int length = strlen(tValue);
+	writeBundleInteger(tWriter, length);
+	writeBundleBytes(tWriter, tValue, length);
+}
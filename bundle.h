@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <tari/geometry.h>
+#include <tari/file.h>
+
+#define BUNDLE_VERSION 5
+
+typedef struct {
+	char* mData;
+	int mSize;
+	int mCapacity;
+} BundleWriter;
+
+typedef struct {
+	Buffer mBuffer;
+	uint32_t mPosition;
+	int mHasFailed;
+	int mSourceSize;
+} BundleReader;
+
+void getBundlePathFromDefinitionPath(char* tDst, char* tDefinitionPath);
+int isBundleCompilationActive();
+
+int openBundleForReading(BundleReader* oReader, char* tPath, char* tType, char* tDefinitionPath);
+int openBundleForReadingFromBuffer(BundleReader* oReader, Buffer tBuffer, char* tType);
+int closeBundleAndReturnWhetherItWasValid(BundleReader* tReader);
+int readBundleInteger(BundleReader* tReader);
+double readBundleFloat(BundleReader* tReader);
+Vector3D readBundleVector3D(BundleReader* tReader);
+char* readAllocatedBundleString(BundleReader* tReader);
+
+void openBundleForWriting(BundleWriter* oWriter, char* tType, char* tDefinitionPath);
+void saveBundleAndClose(BundleWriter* tWriter, char* tPath);
+void writeBundleInteger(BundleWriter* tWriter, int tValue);
+void writeBundleFloat(BundleWriter* tWriter, double tValue);
+void writeBundleVector3D(BundleWriter* tWriter, Vector3D tValue);
+void writeBundleString(BundleWriter* tWriter, char* tValue);
@@ -0,0 +1,34 @@
+#include "bundlecompiler.h"
+
+#include <tari/log.h>
+
+#include "assignment.h"
+#include "enemyhandler.h"
+#include "shothandler.h"
+#include "boss.h"
+#include "level.h"
+#include "collision.h"
+#include "assetregistry.h"
+
+static void loadBundleCompilerScreen() {
+	resetAssetRegistry();
+	loadCollisions();
+
+	// the handlers parse their definitions on load, which writes the shot bundle
+	instantiateActor(AssignmentHandler);
+	instantiateActor(EnemyHandler);
+	instantiateActor(ShotHandler);
+	instantiateActor(BossHandler);
+
+	compileLevelBundles();
+	logg("Bundles compiled");
+}
+
+static void updateBundleCompilerScreen() {
+	abortScreenHandling();
+}
+
+Screen BundleCompilerScreen = {
+	.mLoad = loadBundleCompilerScreen,
+	.mUpdate = updateBundleCompilerScreen,
+};
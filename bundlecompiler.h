@@ -0,0 +1,5 @@
+#pragma once
+
+#include <tari/wrapper.h>
+
+extern Screen BundleCompilerScreen;
@@ -1,6 +1,23 @@
 #include "collision.h"
 
 #include <tari/collisionhandler.h>
+#include <tari/math.h>
+#include <tari/wrapper.h>
+#include <tari/memoryhandler.h>
+
+#define COLLISION_GRID_CELL_SIZE 64
+#define COLLISION_GRID_WIDTH 10
+#define COLLISION_GRID_HEIGHT 6
+#define COLLISION_GRID_CELL_AMOUNT (COLLISION_GRID_WIDTH * COLLISION_GRID_HEIGHT)
+#define COLLISION_BROADPHASE_MARGIN 32
+#define MAX_COLLISION_LIST_AMOUNT 32
+#define INITIAL_COLLISION_EVENT_CAPACITY 1024
+
+typedef struct {
+	CollisionEventCB mCB;
+	void* mCaller;
+	void* mCollisionData;
+} CollisionEvent;
 
 static struct {
 	int mPlayerCollisionList;
@@ -12,8 +29,18 @@ static struct {
 	int mItemCollisionList;
 	int mPlayerItemCollisionList;
 
+	int mBroadphaseTargets[MAX_COLLISION_LIST_AMOUNT];
+	int mHotCells[COLLISION_GRID_CELL_AMOUNT];
+
+	int mEventAmount;
+	int mEventCapacity;
+	CollisionEvent* mEvents;
 } gData;
 
+static void addCollisionBroadphaseCheck(int tShotCollisionList, int tTargetCollisionList) {
+	gData.mBroadphaseTargets[tShotCollisionList] |= (1 << tTargetCollisionList);
+}
+
 void loadCollisions()
 {
 	gData.mPlayerCollisionList = addCollisionListToHandler();
@@ -23,10 +50,19 @@ void loadCollisions()
 	gData.mItemCollisionList = addCollisionListToHandler();
 	gData.mPlayerItemCollisionList = addCollisionListToHandler();
 
-	addCollisionHandlerCheck(gData.mPlayerCollisionList, gData.mEnemyShotCollisionList);
 	addCollisionHandlerCheck(gData.mPlayerCollisionList, gData.mEnemyCollisionList);
 	addCollisionHandlerCheck(gData.mPlayerItemCollisionList, gData.mItemCollisionList);
 	addCollisionHandlerCheck(gData.mEnemyCollisionList, gData.mPlayerShotCollisionList);
+
+	int i;
+	for (i = 0; i < MAX_COLLISION_LIST_AMOUNT; i++) {
+		gData.mBroadphaseTargets[i] = 0;
+	}
+	addCollisionBroadphaseCheck(gData.mPlayerShotCollisionList, gData.mEnemyCollisionList);
+	resetCollisionBroadphase();
+	gData.mEventAmount = 0;
+	gData.mEventCapacity = INITIAL_COLLISION_EVENT_CAPACITY;
+	gData.mEvents = allocMemory(sizeof(CollisionEvent) * gData.mEventCapacity);
 }
 
 int getPlayerCollisionList()
@@ -58,3 +94,72 @@ int getPlayerItemCollisionList()
 {
 	return gData.mPlayerItemCollisionList;
 }
+
+static int getCollisionGridCoordinate(double tValue, int tCellAmount) {
+	int cell = (int)floor(tValue / COLLISION_GRID_CELL_SIZE);
+	return max(0, min(tCellAmount - 1, cell));
+}
+
+void resetCollisionBroadphase()
+{
+	int i;
+	for (i = 0; i < COLLISION_GRID_CELL_AMOUNT; i++) {
+		gData.mHotCells[i] = 0;
+	}
+}
+
+void addCollisionBroadphaseTarget(int tCollisionList, Position tPosition, double tRadius)
+{
+	double radius = tRadius + COLLISION_BROADPHASE_MARGIN;
+	int x0 = getCollisionGridCoordinate(tPosition.x - radius, COLLISION_GRID_WIDTH);
+	int x1 = getCollisionGridCoordinate(tPosition.x + radius, COLLISION_GRID_WIDTH);
+	int y0 = getCollisionGridCoordinate(tPosition.y - radius, COLLISION_GRID_HEIGHT);
+	int y1 = getCollisionGridCoordinate(tPosition.y + radius, COLLISION_GRID_HEIGHT);
+
+	int x, y;
+	for (y = y0; y <= y1; y++) {
+		for (x = x0; x <= x1; x++) {
+			gData.mHotCells[y * COLLISION_GRID_WIDTH + x] |= (1 << tCollisionList);
+		}
+	}
+}
+
+int isCollisionBroadphaseActive(int tCollisionList)
+{
+	return gData.mBroadphaseTargets[tCollisionList] != 0;
+}
+
+int isInCollisionBroadphaseRange(int tCollisionList, Position tPosition)
+{
+	int x = getCollisionGridCoordinate(tPosition.x, COLLISION_GRID_WIDTH);
+	int y = getCollisionGridCoordinate(tPosition.y, COLLISION_GRID_HEIGHT);
+	return (gData.mHotCells[y * COLLISION_GRID_WIDTH + x] & gData.mBroadphaseTargets[tCollisionList]) != 0;
+}
+
+void addCollisionEvent(CollisionEventCB tCB, void* tCaller, void* tCollisionData)
+{
+	if (gData.mEventAmount == gData.mEventCapacity) {
+		gData.mEventCapacity *= 2;
+		gData.mEvents = reallocMemory(gData.mEvents, sizeof(CollisionEvent) * gData.mEventCapacity);
+	}
+
+	CollisionEvent* e = &gData.mEvents[gData.mEventAmount++];
+	e->mCB = tCB;
+	e->mCaller = tCaller;
+	e->mCollisionData = tCollisionData;
+}
+
+static void resolveCollisionEvents(void* tData) {
+	(void)tData;
+
+	int i;
+	for (i = 0; i < gData.mEventAmount; i++) {
+		CollisionEvent* e = &gData.mEvents[i];
+		e->mCB(e->mCaller, e->mCollisionData);
+	}
+	gData.mEventAmount = 0;
+}
+
+ActorBlueprint CollisionEventHandler = {
+	.mUpdate = resolveCollisionEvents,
+};
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <tari/geometry.h>
+#include <tari/actorhandler.h>
+
 typedef enum {
 	ITEM_TYPE_SMALL_POWER,
 	ITEM_TYPE_LIFE,
@@ -12,6 +15,7 @@ typedef struct {
 
 	int mIsItem;
 	ItemType mItemType;
+	int mItemValue;
 } CollisionData;
 
 void loadCollisions();
@@ -21,4 +25,14 @@ int getPlayerShotCollisionList();
 int getEnemyCollisionList();
 int getEnemyShotCollisionList();
 int getItemCollisionList();
-int getPlayerItemCollisionList();
\ No newline at end of file
+int getPlayerItemCollisionList();
+
+void resetCollisionBroadphase();
+void addCollisionBroadphaseTarget(int tCollisionList, Position tPosition, double tRadius);
+int isCollisionBroadphaseActive(int tCollisionList);
+int isInCollisionBroadphaseRange(int tCollisionList, Position tPosition);
+
+typedef void(*CollisionEventCB)(void* tCaller, void* tCollisionData);
+void addCollisionEvent(CollisionEventCB tCB, void* tCaller, void* tCollisionData);
+
+extern ActorBlueprint CollisionEventHandler;
@@ -0,0 +1,821 @@
+#include "compiledassignment.h"
+
+#include <assert.h>
+#include <ctype.h>
+
+#include <tari/datastructures.h>
+#include <tari/mugenassignmentevaluator.h>
+#include <tari/math.h>
+
+#define MAX_REGISTER_AMOUNT 32
+#define MAX_INSTRUCTION_AMOUNT 64
+#define MAX_CONTEXT_ENTRY_AMOUNT 32
+
+typedef enum {
+	COMPILED_OPERATION_LOAD_IMMEDIATE,
+	COMPILED_OPERATION_LOAD_VARIABLE,
+	COMPILED_OPERATION_CALL_ARRAY,
+	COMPILED_OPERATION_ADD,
+	COMPILED_OPERATION_SUBTRACT,
+	COMPILED_OPERATION_MULTIPLY,
+	COMPILED_OPERATION_DIVIDE,
+	COMPILED_OPERATION_DIVIDE_INTEGER,
+	COMPILED_OPERATION_MODULO,
+	COMPILED_OPERATION_POWER,
+	COMPILED_OPERATION_NEGATE,
+	COMPILED_OPERATION_NOT,
+	COMPILED_OPERATION_EQUAL,
+	COMPILED_OPERATION_UNEQUAL,
+	COMPILED_OPERATION_LESS,
+	COMPILED_OPERATION_LESS_OR_EQUAL,
+	COMPILED_OPERATION_GREATER,
+	COMPILED_OPERATION_GREATER_OR_EQUAL,
+	COMPILED_OPERATION_AND,
+	COMPILED_OPERATION_OR,
+	COMPILED_OPERATION_SIN,
+	COMPILED_OPERATION_COS,
+	COMPILED_OPERATION_ABS,
+	COMPILED_OPERATION_SELECT,
+} CompiledOperation;
+
+typedef enum {
+	CONTEXT_ENTRY_TYPE_VARIABLE,
+	CONTEXT_ENTRY_TYPE_CONSTANT,
+	CONTEXT_ENTRY_TYPE_ARRAY,
+} ContextEntryType;
+
+typedef struct {
+	char mName[30];
+	ContextEntryType mType;
+	int mIsInteger;
+	int mDependencies;
+
+	double mValue;
+	CompiledAssignmentVariableFunction mVariable;
+	CompiledAssignmentArrayFunction mFunction;
+} ContextEntry;
+
+static struct {
+	int mEntryAmount;
+	ContextEntry mEntries[MAX_CONTEXT_ENTRY_AMOUNT];
+} gData;
+
+void resetCompiledAssignmentContext()
+{
+	gData.mEntryAmount = 0;
+}
+
+static ContextEntry* addContextEntry(char* tName, ContextEntryType tType, int tIsInteger, int tDependencies) {
+	assert(gData.mEntryAmount < MAX_CONTEXT_ENTRY_AMOUNT);
+	assert(strlen(tName) < sizeof(gData.mEntries[0].mName));
+
+	ContextEntry* e = &gData.mEntries[gData.mEntryAmount++];
+	strcpy(e->mName, tName);
+	e->mType = tType;
+	e->mIsInteger = tIsInteger;
+	e->mDependencies = tDependencies;
+	return e;
+}
+
+void addCompiledAssignmentVariable(char* tName, CompiledAssignmentVariableFunction tFunc, int tIsInteger, int tDependencies)
+{
+	ContextEntry* e = addContextEntry(tName, CONTEXT_ENTRY_TYPE_VARIABLE, tIsInteger, tDependencies);
+	e->mVariable = tFunc;
+}
+
+void addCompiledAssignmentConstant(char* tName, double tValue, int tIsInteger)
+{
+	ContextEntry* e = addContextEntry(tName, CONTEXT_ENTRY_TYPE_CONSTANT, tIsInteger, 0);
+	e->mValue = tValue;
+}
+
+void addCompiledAssignmentArray(char* tName, CompiledAssignmentArrayFunction tFunc, int tIsInteger, int tDependencies)
+{
+	ContextEntry* e = addContextEntry(tName, CONTEXT_ENTRY_TYPE_ARRAY, tIsInteger, tDependencies);
+	e->mFunction = tFunc;
+}
+
+static ContextEntry* findContextEntry(char* tName, ContextEntryType tType) {
+	int i;
+	for (i = 0; i < gData.mEntryAmount; i++) {
+		ContextEntry* e = &gData.mEntries[i];
+		if (e->mType == tType && !strcmp(tName, e->mName)) return e;
+	}
+
+	return NULL;
+}
+
+typedef struct {
+	int mIsConstant;
+	int mIsInteger;
+	double mValue;
+	uint8_t mRegister;
+} CompiledOperand;
+
+typedef struct {
+	char* mText;
+	int mPosition;
+	int mHasFailed;
+
+	CompiledAssignmentInstruction mInstructions[MAX_INSTRUCTION_AMOUNT];
+	int mInstructionAmount;
+	int mRegisterAmount;
+	int mDependencies;
+} CompilerState;
+
+static CompiledOperand makeConstantOperand(double tValue, int tIsInteger) {
+	CompiledOperand ret;
+	ret.mIsConstant = 1;
+	ret.mIsInteger = tIsInteger;
+	ret.mValue = tValue;
+	ret.mRegister = 0;
+	return ret;
+}
+
+static CompiledOperand setCompilerFailed(CompilerState* tState) {
+	tState->mHasFailed = 1;
+	return makeConstantOperand(0, 1);
+}
+
+static CompiledAssignmentInstruction* addInstruction(CompilerState* tState, CompiledOperation tOperation, CompiledOperand* tResult) {
+	if (tState->mInstructionAmount >= MAX_INSTRUCTION_AMOUNT || tState->mRegisterAmount >= MAX_REGISTER_AMOUNT) {
+		tState->mHasFailed = 1;
+		return NULL;
+	}
+
+	CompiledAssignmentInstruction* e = &tState->mInstructions[tState->mInstructionAmount++];
+	memset(e, 0, sizeof(CompiledAssignmentInstruction));
+	e->mOperation = tOperation;
+	e->mDestination = tState->mRegisterAmount++;
+
+	tResult->mIsConstant = 0;
+	tResult->mRegister = e->mDestination;
+	return e;
+}
+
+static uint8_t getOperandRegister(CompilerState* tState, CompiledOperand tOperand) {
+	if (!tOperand.mIsConstant) return tOperand.mRegister;
+
+	CompiledOperand ret = tOperand;
+	CompiledAssignmentInstruction* e = addInstruction(tState, COMPILED_OPERATION_LOAD_IMMEDIATE, &ret);
+	if (!e) return 0;
+	e->mImmediate = tOperand.mValue;
+	return ret.mRegister;
+}
+
+static double performUnaryOperation(CompiledOperation tOperation, double a) {
+	switch (tOperation) {
+	case COMPILED_OPERATION_NEGATE: return -a;
+	case COMPILED_OPERATION_NOT: return !a;
+	case COMPILED_OPERATION_SIN: return sin(a);
+	case COMPILED_OPERATION_COS: return cos(a);
+	case COMPILED_OPERATION_ABS: return fabs(a);
+	default: return 0;
+	}
+}
+
+static double performBinaryOperation(CompiledOperation tOperation, double a, double b) {
+	switch (tOperation) {
+	case COMPILED_OPERATION_ADD: return a + b;
+	case COMPILED_OPERATION_SUBTRACT: return a - b;
+	case COMPILED_OPERATION_MULTIPLY: return a * b;
+	case COMPILED_OPERATION_DIVIDE: return b == 0 ? 0 : a / b;
+	case COMPILED_OPERATION_DIVIDE_INTEGER: return (int)b == 0 ? 0 : (int)a / (int)b;
+	case COMPILED_OPERATION_MODULO: return (int)b == 0 ? 0 : (int)a % (int)b;
+	case COMPILED_OPERATION_POWER: return pow(a, b);
+	case COMPILED_OPERATION_EQUAL: return a == b;
+	case COMPILED_OPERATION_UNEQUAL: return a != b;
+	case COMPILED_OPERATION_LESS: return a < b;
+	case COMPILED_OPERATION_LESS_OR_EQUAL: return a <= b;
+	case COMPILED_OPERATION_GREATER: return a > b;
+	case COMPILED_OPERATION_GREATER_OR_EQUAL: return a >= b;
+	case COMPILED_OPERATION_AND: return a && b;
+	case COMPILED_OPERATION_OR: return a || b;
+	default: return 0;
+	}
+}
+
+static CompiledOperand compileUnaryOperation(CompilerState* tState, CompiledOperation tOperation, CompiledOperand a, int tIsInteger) {
+	if (a.mIsConstant) {
+		return makeConstantOperand(performUnaryOperation(tOperation, a.mValue), tIsInteger);
+	}
+
+	CompiledOperand ret;
+	ret.mIsInteger = tIsInteger;
+	uint8_t registerA = getOperandRegister(tState, a);
+	CompiledAssignmentInstruction* e = addInstruction(tState, tOperation, &ret);
+	if (!e) return setCompilerFailed(tState);
+	e->mA = registerA;
+	return ret;
+}
+
+static CompiledOperand compileBinaryOperation(CompilerState* tState, CompiledOperation tOperation, CompiledOperand a, CompiledOperand b, int tIsInteger) {
+	if (a.mIsConstant && b.mIsConstant) {
+		return makeConstantOperand(performBinaryOperation(tOperation, a.mValue, b.mValue), tIsInteger);
+	}
+
+	CompiledOperand ret;
+	ret.mIsInteger = tIsInteger;
+	uint8_t registerA = getOperandRegister(tState, a);
+	uint8_t registerB = getOperandRegister(tState, b);
+	CompiledAssignmentInstruction* e = addInstruction(tState, tOperation, &ret);
+	if (!e) return setCompilerFailed(tState);
+	e->mA = registerA;
+	e->mB = registerB;
+	return ret;
+}
+
+static void skipWhitespace(CompilerState* tState) {
+	while (isspace((unsigned char)tState->mText[tState->mPosition])) tState->mPosition++;
+}
+
+static char peekCharacter(CompilerState* tState) {
+	skipWhitespace(tState);
+	return tState->mText[tState->mPosition];
+}
+
+static int acceptToken(CompilerState* tState, char* tToken) {
+	skipWhitespace(tState);
+	int length = strlen(tToken);
+	if (strncmp(tState->mText + tState->mPosition, tToken, length)) return 0;
+
+	tState->mPosition += length;
+	return 1;
+}
+
+static CompiledOperand compileExpression(CompilerState* tState);
+static CompiledOperand compileUnary(CompilerState* tState);
+
+static CompiledOperand compileNumber(CompilerState* tState) {
+	char* start = tState->mText + tState->mPosition;
+	char* end;
+	double value = strtod(start, &end);
+	if (end == start) return setCompilerFailed(tState);
+
+	int isInteger = 1;
+	char* current;
+	for (current = start; current < end; current++) {
+		if (*current == '.' || *current == 'e') isInteger = 0;
+	}
+
+	tState->mPosition += end - start;
+	return makeConstantOperand(value, isInteger);
+}
+
+static int compileArguments(CompilerState* tState, CompiledOperand* tArguments, int tAmount) {
+	int i;
+	for (i = 0; i < tAmount; i++) {
+		if (i && !acceptToken(tState, ",")) return 0;
+		tArguments[i] = compileExpression(tState);
+	}
+
+	return acceptToken(tState, ")");
+}
+
+static CompiledOperand compileSelect(CompilerState* tState, CompiledOperand* tArguments) {
+	if (tArguments[0].mIsConstant) {
+		return tArguments[0].mValue ? tArguments[1] : tArguments[2];
+	}
+
+	CompiledOperand ret;
+	ret.mIsInteger = tArguments[1].mIsInteger && tArguments[2].mIsInteger;
+	uint8_t registerA = getOperandRegister(tState, tArguments[0]);
+	uint8_t registerB = getOperandRegister(tState, tArguments[1]);
+	uint8_t registerC = getOperandRegister(tState, tArguments[2]);
+	CompiledAssignmentInstruction* e = addInstruction(tState, COMPILED_OPERATION_SELECT, &ret);
+	if (!e) return setCompilerFailed(tState);
+	e->mA = registerA;
+	e->mB = registerB;
+	e->mC = registerC;
+	return ret;
+}
+
+static CompiledOperand compileArray(CompilerState* tState, char* tName) {
+	CompiledOperand arguments[3];
+
+	if (!strcmp("sin", tName) || !strcmp("cos", tName) || !strcmp("abs", tName)) {
+		if (!compileArguments(tState, arguments, 1)) return setCompilerFailed(tState);
+		CompiledOperation operation = !strcmp("sin", tName) ? COMPILED_OPERATION_SIN : (!strcmp("cos", tName) ? COMPILED_OPERATION_COS : COMPILED_OPERATION_ABS);
+		int isInteger = operation == COMPILED_OPERATION_ABS && arguments[0].mIsInteger;
+		return compileUnaryOperation(tState, operation, arguments[0], isInteger);
+	}
+	else if (!strcmp("ifelse", tName)) {
+		if (!compileArguments(tState, arguments, 3)) return setCompilerFailed(tState);
+		return compileSelect(tState, arguments);
+	}
+
+	ContextEntry* entry = findContextEntry(tName, CONTEXT_ENTRY_TYPE_ARRAY);
+	if (!entry || !compileArguments(tState, arguments, 2)) return setCompilerFailed(tState);
+
+	CompiledOperand ret;
+	ret.mIsInteger = entry->mIsInteger;
+	uint8_t registerA = getOperandRegister(tState, arguments[0]);
+	uint8_t registerB = getOperandRegister(tState, arguments[1]);
+	CompiledAssignmentInstruction* e = addInstruction(tState, COMPILED_OPERATION_CALL_ARRAY, &ret);
+	if (!e) return setCompilerFailed(tState);
+	e->mA = registerA;
+	e->mB = registerB;
+	e->mFunction = entry->mFunction;
+	tState->mDependencies |= entry->mDependencies;
+	return ret;
+}
+
+static CompiledOperand compileIdentifier(CompilerState* tState) {
+	char name[30];
+	int length = 0;
+	while (isalnum((unsigned char)tState->mText[tState->mPosition]) || tState->mText[tState->mPosition] == '_') {
+		if (length >= (int)sizeof(name) - 1) return setCompilerFailed(tState);
+		name[length++] = tolower((unsigned char)tState->mText[tState->mPosition++]);
+	}
+	name[length] = '\0';
+
+	if (acceptToken(tState, "(")) {
+		return compileArray(tState, name);
+	}
+
+	ContextEntry* constant = findContextEntry(name, CONTEXT_ENTRY_TYPE_CONSTANT);
+	if (constant) {
+		return makeConstantOperand(constant->mValue, constant->mIsInteger);
+	}
+
+	ContextEntry* variable = findContextEntry(name, CONTEXT_ENTRY_TYPE_VARIABLE);
+	if (!variable) return setCompilerFailed(tState);
+
+	CompiledOperand ret;
+	ret.mIsInteger = variable->mIsInteger;
+	CompiledAssignmentInstruction* e = addInstruction(tState, COMPILED_OPERATION_LOAD_VARIABLE, &ret);
+	if (!e) return setCompilerFailed(tState);
+	e->mVariable = variable->mVariable;
+	tState->mDependencies |= variable->mDependencies;
+	return ret;
+}
+
+static CompiledOperand compilePrimary(CompilerState* tState) {
+	char c = peekCharacter(tState);
+
+	if (c == '(') {
+		tState->mPosition++;
+		CompiledOperand ret = compileExpression(tState);
+		if (!acceptToken(tState, ")")) return setCompilerFailed(tState);
+		return ret;
+	}
+	else if (isdigit((unsigned char)c) || c == '.') {
+		return compileNumber(tState);
+	}
+	else if (isalpha((unsigned char)c) || c == '_') {
+		return compileIdentifier(tState);
+	}
+
+	return setCompilerFailed(tState);
+}
+
+static CompiledOperand compilePower(CompilerState* tState) {
+	CompiledOperand a = compilePrimary(tState);
+	if (!acceptToken(tState, "**")) return a;
+
+	CompiledOperand b = compileUnary(tState);
+	return compileBinaryOperation(tState, COMPILED_OPERATION_POWER, a, b, a.mIsInteger && b.mIsInteger);
+}
+
+static CompiledOperand compileUnary(CompilerState* tState) {
+	if (acceptToken(tState, "!=")) {
+		return setCompilerFailed(tState);
+	}
+	else if (acceptToken(tState, "-")) {
+		CompiledOperand a = compileUnary(tState);
+		return compileUnaryOperation(tState, COMPILED_OPERATION_NEGATE, a, a.mIsInteger);
+	}
+	else if (acceptToken(tState, "!")) {
+		CompiledOperand a = compileUnary(tState);
+		return compileUnaryOperation(tState, COMPILED_OPERATION_NOT, a, 1);
+	}
+	else if (acceptToken(tState, "+")) {
+		return compileUnary(tState);
+	}
+
+	return compilePower(tState);
+}
+
+static CompiledOperand compileTerm(CompilerState* tState) {
+	CompiledOperand a = compileUnary(tState);
+
+	while (!tState->mHasFailed) {
+		char c = peekCharacter(tState);
+		if (c == '*' && tState->mText[tState->mPosition + 1] == '*') break;
+
+		CompiledOperation operation;
+		int isInteger = a.mIsInteger;
+		if (acceptToken(tState, "*")) operation = COMPILED_OPERATION_MULTIPLY;
+		else if (acceptToken(tState, "/")) operation = COMPILED_OPERATION_DIVIDE;
+		else if (acceptToken(tState, "%")) operation = COMPILED_OPERATION_MODULO;
+		else break;
+
+		CompiledOperand b = compileUnary(tState);
+		isInteger = isInteger && b.mIsInteger;
+		if (operation == COMPILED_OPERATION_DIVIDE && isInteger) operation = COMPILED_OPERATION_DIVIDE_INTEGER;
+		if (operation == COMPILED_OPERATION_MODULO) isInteger = 1;
+		a = compileBinaryOperation(tState, operation, a, b, isInteger);
+	}
+
+	return a;
+}
+
+static CompiledOperand compileAdditive(CompilerState* tState) {
+	CompiledOperand a = compileTerm(tState);
+
+	while (!tState->mHasFailed) {
+		CompiledOperation operation;
+		if (acceptToken(tState, "+")) operation = COMPILED_OPERATION_ADD;
+		else if (acceptToken(tState, "-")) operation = COMPILED_OPERATION_SUBTRACT;
+		else break;
+
+		CompiledOperand b = compileTerm(tState);
+		a = compileBinaryOperation(tState, operation, a, b, a.mIsInteger && b.mIsInteger);
+	}
+
+	return a;
+}
+
+static CompiledOperand compileRelational(CompilerState* tState) {
+	CompiledOperand a = compileAdditive(tState);
+
+	while (!tState->mHasFailed) {
+		CompiledOperation operation;
+		if (acceptToken(tState, "<=")) operation = COMPILED_OPERATION_LESS_OR_EQUAL;
+		else if (acceptToken(tState, ">=")) operation = COMPILED_OPERATION_GREATER_OR_EQUAL;
+		else if (acceptToken(tState, "<")) operation = COMPILED_OPERATION_LESS;
+		else if (acceptToken(tState, ">")) operation = COMPILED_OPERATION_GREATER;
+		else break;
+
+		CompiledOperand b = compileAdditive(tState);
+		a = compileBinaryOperation(tState, operation, a, b, 1);
+	}
+
+	return a;
+}
+
+static CompiledOperand compileEquality(CompilerState* tState) {
+	CompiledOperand a = compileRelational(tState);
+
+	while (!tState->mHasFailed) {
+		CompiledOperation operation;
+		if (acceptToken(tState, "!=")) operation = COMPILED_OPERATION_UNEQUAL;
+		else if (acceptToken(tState, "=")) operation = COMPILED_OPERATION_EQUAL;
+		else break;
+
+		CompiledOperand b = compileRelational(tState);
+		a = compileBinaryOperation(tState, operation, a, b, 1);
+	}
+
+	return a;
+}
+
+static CompiledOperand compileAnd(CompilerState* tState) {
+	CompiledOperand a = compileEquality(tState);
+
+	while (!tState->mHasFailed && acceptToken(tState, "&&")) {
+		CompiledOperand b = compileEquality(tState);
+		a = compileBinaryOperation(tState, COMPILED_OPERATION_AND, a, b, 1);
+	}
+
+	return a;
+}
+
+static CompiledOperand compileExpression(CompilerState* tState) {
+	CompiledOperand a = compileAnd(tState);
+
+	while (!tState->mHasFailed && acceptToken(tState, "||")) {
+		CompiledOperand b = compileAnd(tState);
+		a = compileBinaryOperation(tState, COMPILED_OPERATION_OR, a, b, 1);
+	}
+
+	return a;
+}
+
+static int isTextEmpty(char* tText) {
+	while (*tText) {
+		if (!isspace((unsigned char)*tText)) return 0;
+		tText++;
+	}
+
+	return 1;
+}
+
+static int compileAssignmentText(CompiledAssignment* e, char* tText) {
+	if (isTextEmpty(tText)) {
+		e->mIsEmpty = 1;
+		e->mIsConstant = 1;
+		return 1;
+	}
+
+	CompilerState state;
+	state.mText = tText;
+	state.mPosition = 0;
+	state.mHasFailed = 0;
+	state.mInstructionAmount = 0;
+	state.mRegisterAmount = 0;
+	state.mDependencies = 0;
+
+	CompiledOperand components[3];
+	int componentAmount = 0;
+	do {
+		if (componentAmount >= 3) return 0;
+		components[componentAmount++] = compileExpression(&state);
+		if (state.mHasFailed) return 0;
+	} while (acceptToken(&state, ","));
+
+	if (peekCharacter(&state) != '\0') return 0;
+
+	int isConstant = 1;
+	int i;
+	for (i = 0; i < componentAmount; i++) {
+		isConstant = isConstant && components[i].mIsConstant;
+	}
+
+	e->mComponentAmount = componentAmount;
+	e->mConstantValue = makePosition(0, 0, 0);
+	e->mDependencies = state.mDependencies;
+	e->mIsConstant = isConstant;
+	if (isConstant) {
+		e->mConstantValue.x = components[0].mValue;
+		if (componentAmount > 1) e->mConstantValue.y = components[1].mValue;
+		if (componentAmount > 2) e->mConstantValue.z = components[2].mValue;
+		return 1;
+	}
+
+	for (i = 0; i < componentAmount; i++) {
+		e->mResultRegisters[i] = getOperandRegister(&state, components[i]);
+	}
+	if (state.mHasFailed) return 0;
+
+	e->mInstructionAmount = state.mInstructionAmount;
+	e->mRegisterAmount = state.mRegisterAmount;
+	e->mInstructions = allocMemory(sizeof(CompiledAssignmentInstruction) * state.mInstructionAmount);
+	memcpy(e->mInstructions, state.mInstructions, sizeof(CompiledAssignmentInstruction) * state.mInstructionAmount);
+
+	return 1;
+}
+
+static CompiledAssignment* makeEmptyCompiledAssignment() {
+	CompiledAssignment* e = allocMemory(sizeof(CompiledAssignment));
+	memset(e, 0, sizeof(CompiledAssignment));
+	return e;
+}
+
+static char* copyToAllocatedFallbackText(char* tText) {
+	char* ret = allocMemory(strlen(tText) + 1);
+	strcpy(ret, tText);
+	return ret;
+}
+
+static int fetchCompiledAssignmentFromGroup(char* tName, MugenDefScriptGroup* tGroup, CompiledAssignment** tOutput, char* tDefault) {
+	CompiledAssignment* e = makeEmptyCompiledAssignment();
+	*tOutput = e;
+
+	int exists = string_map_contains(&tGroup->mElements, tName);
+	if (!exists && !tDefault) {
+		e->mIsEmpty = 1;
+		e->mIsConstant = 1;
+		return 0;
+	}
+
+	char* text = exists ? getAllocatedMugenDefStringVariableAsGroup(tGroup, tName) : NULL;
+	int hasCompiled = compileAssignmentText(e, exists ? text : tDefault);
+	if (text) freeMemory(text);
+	if (hasCompiled) return exists;
+
+	memset(e, 0, sizeof(CompiledAssignment));
+	e->mDependencies = COMPILED_ASSIGNMENT_DEPENDENCY_ALL;
+	e->mFallbackText = exists ? getAllocatedMugenDefStringVariableAsGroup(tGroup, tName) : copyToAllocatedFallbackText(tDefault);
+	if (tDefault) {
+		fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString(tName, tGroup, &e->mFallback, tDefault);
+	}
+	else {
+		fetchMugenAssignmentFromGroupAndReturnWhetherItExists(tName, tGroup, &e->mFallback);
+	}
+
+	return exists;
+}
+
+int fetchCompiledAssignmentFromGroupAndReturnWhetherItExists(char* tName, MugenDefScriptGroup* tGroup, CompiledAssignment** tOutput)
+{
+	return fetchCompiledAssignmentFromGroup(tName, tGroup, tOutput, NULL);
+}
+
+int fetchCompiledAssignmentFromGroupAndReturnWhetherItExistsDefaultString(char* tName, MugenDefScriptGroup* tGroup, CompiledAssignment** tOutput, char* tDefault)
+{
+	return fetchCompiledAssignmentFromGroup(tName, tGroup, tOutput, tDefault);
+}
+
+void destroyCompiledAssignment(CompiledAssignment* tAssignment)
+{
+	if (tAssignment->mInstructions) freeMemory(tAssignment->mInstructions);
+	if (tAssignment->mFallback) destroyMugenAssignment(tAssignment->mFallback);
+	if (tAssignment->mFallbackText) freeMemory(tAssignment->mFallbackText);
+	freeMemory(tAssignment);
+}
+
+static char* getContextEntryNameFromFunctions(CompiledAssignmentVariableFunction tVariable, CompiledAssignmentArrayFunction tFunction) {
+	if (!tVariable && !tFunction) return "";
+
+	int i;
+	for (i = 0; i < gData.mEntryAmount; i++) {
+		ContextEntry* e = &gData.mEntries[i];
+		if (tVariable && e->mType == CONTEXT_ENTRY_TYPE_VARIABLE && e->mVariable == tVariable) return e->mName;
+		if (tFunction && e->mType == CONTEXT_ENTRY_TYPE_ARRAY && e->mFunction == tFunction) return e->mName;
+	}
+
+	logError("Unable to find context entry for compiled instruction.");
+	abortSystem();
+	return "";
+}
+
+void writeCompiledAssignmentToBundle(BundleWriter* tWriter, CompiledAssignment* tAssignment)
+{
+	writeBundleInteger(tWriter, tAssignment->mFallback != NULL);
+	if (tAssignment->mFallback) {
+		writeBundleString(tWriter, tAssignment->mFallbackText);
+		return;
+	}
+
+	writeBundleInteger(tWriter, tAssignment->mIsEmpty);
+	writeBundleInteger(tWriter, tAssignment->mIsConstant);
+	writeBundleInteger(tWriter, tAssignment->mDependencies);
+	writeBundleInteger(tWriter, tAssignment->mComponentAmount);
+	writeBundleVector3D(tWriter, tAssignment->mConstantValue);
+	if (tAssignment->mIsConstant) return;
+
+	int i;
+	for (i = 0; i < 3; i++) {
+		writeBundleInteger(tWriter, tAssignment->mResultRegisters[i]);
+	}
+	writeBundleInteger(tWriter, tAssignment->mRegisterAmount);
+	writeBundleInteger(tWriter, tAssignment->mInstructionAmount);
+	for (i = 0; i < tAssignment->mInstructionAmount; i++) {
+		CompiledAssignmentInstruction* instruction = &tAssignment->mInstructions[i];
+		writeBundleInteger(tWriter, instruction->mOperation);
+		writeBundleInteger(tWriter, instruction->mDestination);
+		writeBundleInteger(tWriter, instruction->mA);
+		writeBundleInteger(tWriter, instruction->mB);
+		writeBundleInteger(tWriter, instruction->mC);
+		writeBundleFloat(tWriter, instruction->mImmediate);
+		writeBundleInteger(tWriter, instruction->mVariable != NULL);
+		writeBundleString(tWriter, getContextEntryNameFromFunctions(instruction->mVariable, instruction->mFunction));
+	}
+}
+
+static void readCompiledAssignmentInstructionFunctionFromBundle(BundleReader* tReader, CompiledAssignmentInstruction* e) {
+	int isVariable = readBundleInteger(tReader);
+	char* name = readAllocatedBundleString(tReader);
+	e->mVariable = NULL;
+	e->mFunction = NULL;
+
+	if (*name) {
+		ContextEntry* entry = findContextEntry(name, isVariable ? CONTEXT_ENTRY_TYPE_VARIABLE : CONTEXT_ENTRY_TYPE_ARRAY);
+		if (!entry) tReader->mHasFailed = 1;
+		else if (isVariable) e->mVariable = entry->mVariable;
+		else e->mFunction = entry->mFunction;
+	}
+	freeMemory(name);
+}
+
+CompiledAssignment* readCompiledAssignmentFromBundle(BundleReader* tReader)
+{
+	CompiledAssignment* e = makeEmptyCompiledAssignment();
+
+	int isFallback = readBundleInteger(tReader);
+	if (isFallback) {
+		e->mDependencies = COMPILED_ASSIGNMENT_DEPENDENCY_ALL;
+		e->mFallbackText = readAllocatedBundleString(tReader);
+		e->mFallback = parseMugenAssignmentFromString(e->mFallbackText);
+		return e;
+	}
+
+	e->mIsEmpty = readBundleInteger(tReader);
+	e->mIsConstant = readBundleInteger(tReader);
+	e->mDependencies = readBundleInteger(tReader);
+	e->mComponentAmount = readBundleInteger(tReader);
+	e->mConstantValue = readBundleVector3D(tReader);
+	if (e->mIsConstant) return e;
+
+	int i;
+	for (i = 0; i < 3; i++) {
+		e->mResultRegisters[i] = (uint8_t)readBundleInteger(tReader);
+	}
+	e->mRegisterAmount = readBundleInteger(tReader);
+	e->mInstructionAmount = readBundleInteger(tReader);
+	if (e->mInstructionAmount < 0 || e->mInstructionAmount > MAX_INSTRUCTION_AMOUNT || e->mRegisterAmount > MAX_REGISTER_AMOUNT || tReader->mHasFailed) {
+		tReader->mHasFailed = 1;
+		e->mIsConstant = 1;
+		e->mInstructionAmount = 0;
+		return e;
+	}
+
+	e->mInstructions = allocMemory(sizeof(CompiledAssignmentInstruction) * e->mInstructionAmount);
+	for (i = 0; i < e->mInstructionAmount; i++) {
+		CompiledAssignmentInstruction* instruction = &e->mInstructions[i];
+		instruction->mOperation = (uint8_t)readBundleInteger(tReader);
+		instruction->mDestination = (uint8_t)readBundleInteger(tReader);
+		instruction->mA = (uint8_t)readBundleInteger(tReader);
+		instruction->mB = (uint8_t)readBundleInteger(tReader);
+		instruction->mC = (uint8_t)readBundleInteger(tReader);
+		instruction->mImmediate = readBundleFloat(tReader);
+		readCompiledAssignmentInstructionFunctionFromBundle(tReader, instruction);
+		if (instruction->mOperation == COMPILED_OPERATION_LOAD_VARIABLE && !instruction->mVariable) tReader->mHasFailed = 1;
+		if (instruction->mOperation == COMPILED_OPERATION_CALL_ARRAY && !instruction->mFunction) tReader->mHasFailed = 1;
+		if (instruction->mDestination >= MAX_REGISTER_AMOUNT || instruction->mA >= MAX_REGISTER_AMOUNT || instruction->mB >= MAX_REGISTER_AMOUNT || instruction->mC >= MAX_REGISTER_AMOUNT) {
+			tReader->mHasFailed = 1;
+		}
+	}
+
+	if (tReader->mHasFailed) {
+		e->mIsConstant = 1;
+		e->mInstructionAmount = 0;
+	}
+
+	return e;
+}
+
+static void runCompiledAssignment(CompiledAssignment* e, void* tCaller, double* r) {
+	int i;
+	for (i = 0; i < e->mInstructionAmount; i++) {
+		CompiledAssignmentInstruction* instruction = &e->mInstructions[i];
+
+		switch (instruction->mOperation) {
+		case COMPILED_OPERATION_LOAD_IMMEDIATE:
+			r[instruction->mDestination] = instruction->mImmediate;
+			break;
+		case COMPILED_OPERATION_LOAD_VARIABLE:
+			r[instruction->mDestination] = instruction->mVariable(tCaller);
+			break;
+		case COMPILED_OPERATION_CALL_ARRAY:
+			r[instruction->mDestination] = instruction->mFunction(r[instruction->mA], r[instruction->mB]);
+			break;
+		case COMPILED_OPERATION_SELECT:
+			r[instruction->mDestination] = r[instruction->mA] ? r[instruction->mB] : r[instruction->mC];
+			break;
+		case COMPILED_OPERATION_NEGATE:
+		case COMPILED_OPERATION_NOT:
+		case COMPILED_OPERATION_SIN:
+		case COMPILED_OPERATION_COS:
+		case COMPILED_OPERATION_ABS:
+			r[instruction->mDestination] = performUnaryOperation(instruction->mOperation, r[instruction->mA]);
+			break;
+		default:
+			r[instruction->mDestination] = performBinaryOperation(instruction->mOperation, r[instruction->mA], r[instruction->mB]);
+			break;
+		}
+	}
+}
+
+Vector3D evaluateCompiledAssignmentAndReturnAsVector3D(CompiledAssignment* tAssignment, void* tCaller)
+{
+	if (tAssignment->mFallback) return evaluateMugenAssignmentAndReturnAsVector3D(tAssignment->mFallback, tCaller);
+	if (tAssignment->mIsConstant) return tAssignment->mConstantValue;
+
+	double r[MAX_REGISTER_AMOUNT];
+	runCompiledAssignment(tAssignment, tCaller, r);
+
+	Vector3D ret = makePosition(0, 0, 0);
+	ret.x = r[tAssignment->mResultRegisters[0]];
+	if (tAssignment->mComponentAmount > 1) ret.y = r[tAssignment->mResultRegisters[1]];
+	if (tAssignment->mComponentAmount > 2) ret.z = r[tAssignment->mResultRegisters[2]];
+	return ret;
+}
+
+double evaluateCompiledAssignmentAndReturnAsFloat(CompiledAssignment* tAssignment, void* tCaller)
+{
+	if (tAssignment->mFallback) return evaluateMugenAssignmentAndReturnAsFloat(tAssignment->mFallback, tCaller);
+	if (tAssignment->mIsConstant) return tAssignment->mConstantValue.x;
+
+	double r[MAX_REGISTER_AMOUNT];
+	runCompiledAssignment(tAssignment, tCaller, r);
+	return r[tAssignment->mResultRegisters[0]];
+}
+
+int evaluateCompiledAssignmentAndReturnAsInteger(CompiledAssignment* tAssignment, void* tCaller)
+{
+	if (tAssignment->mFallback) return evaluateMugenAssignmentAndReturnAsInteger(tAssignment->mFallback, tCaller);
+	return (int)evaluateCompiledAssignmentAndReturnAsFloat(tAssignment, tCaller);
+}
+
+double getCompiledAssignmentAsFloatValueOrDefaultWhenEmpty(CompiledAssignment* tAssignment, void* tCaller, double tDefault)
+{
+	if (tAssignment->mFallback) return getMugenAssignmentAsFloatValueOrDefaultWhenEmpty(tAssignment->mFallback, tCaller, tDefault);
+	if (tAssignment->mIsEmpty) return tDefault;
+	return evaluateCompiledAssignmentAndReturnAsFloat(tAssignment, tCaller);
+}
+
+int getCompiledAssignmentAsIntegerValueOrDefaultWhenEmpty(CompiledAssignment* tAssignment, void* tCaller, int tDefault)
+{
+	if (tAssignment->mFallback) return getMugenAssignmentAsIntegerValueOrDefaultWhenEmpty(tAssignment->mFallback, tCaller, tDefault);
+	if (tAssignment->mIsEmpty) return tDefault;
+	return evaluateCompiledAssignmentAndReturnAsInteger(tAssignment, tCaller);
+}
+
+Vector3D getCompiledAssignmentAsVector3DValueOrDefaultWhenEmpty(CompiledAssignment* tAssignment, void* tCaller, Vector3D tDefault)
+{
+	if (tAssignment->mFallback) return getMugenAssignmentAsVector3DValueOrDefaultWhenEmpty(tAssignment->mFallback, tCaller, tDefault);
+	if (tAssignment->mIsEmpty) return tDefault;
+	return evaluateCompiledAssignmentAndReturnAsVector3D(tAssignment, tCaller);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <tari/mugendefreader.h>
+#include <tari/mugenassignment.h>
+#include <tari/geometry.h>
+
+#include "bundle.h"
+
+typedef enum {
+	COMPILED_ASSIGNMENT_DEPENDENCY_RANDOM = (1 << 0),
+	COMPILED_ASSIGNMENT_DEPENDENCY_INDEX = (1 << 1),
+	COMPILED_ASSIGNMENT_DEPENDENCY_STATE = (1 << 2),
+	COMPILED_ASSIGNMENT_DEPENDENCY_ENEMY_INDEX = (1 << 3),
+	COMPILED_ASSIGNMENT_DEPENDENCY_ALL = 0xFF,
+} CompiledAssignmentDependency;
+
+typedef double(*CompiledAssignmentVariableFunction)(void* tCaller);
+typedef double(*CompiledAssignmentArrayFunction)(double tA, double tB);
+
+typedef struct {
+	uint8_t mOperation;
+	uint8_t mDestination;
+	uint8_t mA;
+	uint8_t mB;
+	uint8_t mC;
+
+	double mImmediate;
+	CompiledAssignmentVariableFunction mVariable;
+	CompiledAssignmentArrayFunction mFunction;
+} CompiledAssignmentInstruction;
+
+typedef struct {
+	int mIsEmpty;
+	int mIsConstant;
+	int mDependencies;
+
+	int mInstructionAmount;
+	CompiledAssignmentInstruction* mInstructions;
+	int mRegisterAmount;
+
+	int mComponentAmount;
+	uint8_t mResultRegisters[3];
+	Vector3D mConstantValue;
+
+	MugenAssignment* mFallback;
+	char* mFallbackText;
+} CompiledAssignment;
+
+void resetCompiledAssignmentContext();
+void addCompiledAssignmentVariable(char* tName, CompiledAssignmentVariableFunction tFunc, int tIsInteger, int tDependencies);
+void addCompiledAssignmentConstant(char* tName, double tValue, int tIsInteger);
+void addCompiledAssignmentArray(char* tName, CompiledAssignmentArrayFunction tFunc, int tIsInteger, int tDependencies);
+
+int fetchCompiledAssignmentFromGroupAndReturnWhetherItExists(char* tName, MugenDefScriptGroup* tGroup, CompiledAssignment** tOutput);
+int fetchCompiledAssignmentFromGroupAndReturnWhetherItExistsDefaultString(char* tName, MugenDefScriptGroup* tGroup, CompiledAssignment** tOutput, char* tDefault);
+
+void destroyCompiledAssignment(CompiledAssignment* tAssignment);
+
+void writeCompiledAssignmentToBundle(BundleWriter* tWriter, CompiledAssignment* tAssignment);
+CompiledAssignment* readCompiledAssignmentFromBundle(BundleReader* tReader);
+
+double evaluateCompiledAssignmentAndReturnAsFloat(CompiledAssignment* tAssignment, void* tCaller);
+int evaluateCompiledAssignmentAndReturnAsInteger(CompiledAssignment* tAssignment, void* tCaller);
+Vector3D evaluateCompiledAssignmentAndReturnAsVector3D(CompiledAssignment* tAssignment, void* tCaller);
+
+double getCompiledAssignmentAsFloatValueOrDefaultWhenEmpty(CompiledAssignment* tAssignment, void* tCaller, double tDefault);
+int getCompiledAssignmentAsIntegerValueOrDefaultWhenEmpty(CompiledAssignment* tAssignment, void* tCaller, int tDefault);
+Vector3D getCompiledAssignmentAsVector3DValueOrDefaultWhenEmpty(CompiledAssignment* tAssignment, void* tCaller, Vector3D tDefault);
@@ -12,6 +12,8 @@
 #include "titlescreen.h"
 #include "player.h"
 #include "gameoverscreen.h"
+#include "level.h"
+#include "assetregistry.h"
 
 
 static struct {
@@ -33,10 +35,10 @@ static struct {
 static void loadContinueHandler(void* tData) {
 	(void)tData;
 
-	gData.mSprites = loadMugenSpriteFileWithoutPalette("assets/continue/CONTINUE.sff");
-	gData.mAnimations = loadMugenAnimationFile("assets/continue/CONTINUE.air");
+	gData.mSprites = acquireMugenSpriteFileWithoutPalette("assets/continue/CONTINUE.sff");
+	gData.mAnimations = acquireMugenAnimationFile("assets/continue/CONTINUE.air");
 
-	gData.mWhiteTexture = loadTexture("$/rd/effects/white.pkg");
+	gData.mWhiteTexture = acquireTexture("$/rd/effects/white.pkg");
 
 	gData.mIsActive = 0;
 }
@@ -72,6 +74,7 @@ static void continueGame() {
 	removeHandledAnimation(gData.mBlackBackgroundID);
 	removeHandledText(gData.mTextID);
 
+	restoreLevelCheckpoint();
 	reduceContinueAmount();
 	setPlayerToFullPower();
 	
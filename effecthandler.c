@@ -2,6 +2,8 @@
 
 #include <tari/mugenanimationhandler.h>
 
+#include "assetregistry.h"
+
 static struct {
 	MugenSpriteFile mSprites;
 	MugenAnimations mAnimations;
@@ -10,8 +12,8 @@ static struct {
 
 static void loadEffectHandler(void* tData) {
 	(void)tData;
-	gData.mSprites = loadMugenSpriteFileWithoutPalette("assets/effects/EFFECTS.sff");
-	gData.mAnimations = loadMugenAnimationFile("assets/effects/EFFECTS.air");
+	gData.mSprites = acquireMugenSpriteFileWithoutPalette("assets/effects/EFFECTS.sff");
+	gData.mAnimations = acquireMugenAnimationFile("assets/effects/EFFECTS.air");
 }
 
 ActorBlueprint EffectHandler = {
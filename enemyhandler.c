@@ -1,6 +1,7 @@
 #include "enemyhandler.h"
 
 #include <assert.h>
+#include <math.h>
 
 #include <tari/collisionhandler.h>
 #include <tari/datastructures.h>
@@ -33,7 +34,6 @@ typedef enum {
 typedef struct {
 	int mType;
 	
-	int mListID;
 	int mPhysicsID;
 	int mAnimationID;
 	
@@ -48,6 +48,9 @@ typedef struct {
 	Position mFinalPosition;
 	EnemyMovementType mMovementType;
 	EnemyMovementState mMovementState;
+	Position mLegTarget;
+	Velocity mLegStep;
+	int mLegFramesLeft;
 
 	Duration mWaitNow;
 	Duration mWaitDuration;
@@ -56,23 +59,65 @@ typedef struct {
 	int mHealth;
 
 	int mIsAlive;
+	int mIndex;
 
 	StageEnemy* mEnemyBase;
 } ActiveEnemy;
 
+#define ENEMY_GRID_CELL_SIZE 64
+#define ENEMY_GRID_WIDTH 10
+#define ENEMY_GRID_HEIGHT 6
+#define ENEMY_GRID_CELL_AMOUNT (ENEMY_GRID_WIDTH * ENEMY_GRID_HEIGHT)
+#define MAX_INDEXED_ENEMY_AMOUNT 256
+
+typedef struct {
+	int mIsDirty;
+	int mHasOverflowed;
+
+	int mCellStart[ENEMY_GRID_CELL_AMOUNT + 1];
+	Position mCellPositions[MAX_INDEXED_ENEMY_AMOUNT];
+
+	int mOutsideAmount;
+	Position mOutsidePositions[MAX_INDEXED_ENEMY_AMOUNT];
+
+	int mAmount;
+	Position mPositions[MAX_INDEXED_ENEMY_AMOUNT];
+	int mCells[MAX_INDEXED_ENEMY_AMOUNT];
+} EnemySpatialIndex;
+
 static struct {
 	MugenAnimations* mEnemyAnimations;
 	MugenSpriteFile* mEnemySprites;
 
 	IntMap mEnemyTypes;
 
-	List mActiveEnemies;
+	ActiveEnemy** mActiveEnemies; // living enemies first, killed ones wait behind them for the sweep
+	int mActiveEnemyAmount;
+	int mActiveEnemyCapacity;
+	int mAliveEnemyAmount;
+	EnemySpatialIndex mIndex;
+
+	ActiveEnemy* mCheckpointEnemies;
+	Position* mCheckpointPositions;
+	int mCheckpointEnemyAmount;
+	int mCheckpointEnemyCapacity;
 } gData;
 
+#define INITIAL_ACTIVE_ENEMY_CAPACITY 64
+
 static void loadEnemyHandler(void* tData) {
 	(void)tData;
 	gData.mEnemyTypes = new_int_map();
-	gData.mActiveEnemies = new_list();
+	gData.mActiveEnemyCapacity = INITIAL_ACTIVE_ENEMY_CAPACITY;
+	gData.mActiveEnemies = allocMemory(sizeof(ActiveEnemy*) * gData.mActiveEnemyCapacity);
+	gData.mActiveEnemyAmount = 0;
+	gData.mAliveEnemyAmount = 0;
+	gData.mIndex.mIsDirty = 1;
+
+	gData.mCheckpointEnemyCapacity = INITIAL_ACTIVE_ENEMY_CAPACITY;
+	gData.mCheckpointEnemies = allocMemory(sizeof(ActiveEnemy) * gData.mCheckpointEnemyCapacity);
+	gData.mCheckpointPositions = allocMemory(sizeof(Position) * gData.mCheckpointEnemyCapacity);
+	gData.mCheckpointEnemyAmount = 0;
 }
 
 static int isEnemyTypeGroup(char* tName) {
@@ -90,6 +135,38 @@ static void loadEnemyTypeFromGroup(MugenDefScriptGroup* tGroup) {
 }
 
 
+static void writeSingleEnemyTypeToBundle(void* tCaller, void* tData) {
+	BundleWriter* writer = tCaller;
+	EnemyType* e = tData;
+
+	writeBundleInteger(writer, e->mID);
+	writeBundleInteger(writer, e->mIdleAnimation);
+	writeBundleInteger(writer, e->mDeathAnimation);
+}
+
+void writeEnemyTypesToBundle(BundleWriter* tWriter)
+{
+	writeBundleInteger(tWriter, int_map_size(&gData.mEnemyTypes));
+	int_map_map(&gData.mEnemyTypes, writeSingleEnemyTypeToBundle, tWriter);
+}
+
+void loadEnemyTypesFromBundle(BundleReader* tReader, MugenAnimations* tAnimations, MugenSpriteFile* tSprites)
+{
+	gData.mEnemyAnimations = tAnimations;
+	gData.mEnemySprites = tSprites;
+
+	int amount = readBundleInteger(tReader);
+	int i;
+	for (i = 0; i < amount && !tReader->mHasFailed; i++) {
+		EnemyType* e = allocMemory(sizeof(EnemyType));
+		e->mID = readBundleInteger(tReader);
+		e->mIdleAnimation = readBundleInteger(tReader);
+		e->mDeathAnimation = readBundleInteger(tReader);
+
+		int_map_push_owned(&gData.mEnemyTypes, e->mID, e);
+	}
+}
+
 void loadEnemyTypesFromScript(MugenDefScript* tScript, MugenAnimations* tAnimations, MugenSpriteFile* tSprites)
 {
 	gData.mEnemyAnimations = tAnimations;
@@ -111,16 +188,67 @@ static int getEnemyTypeIdleAnimation(int tID) {
 	return e->mIdleAnimation;
 }
 
-static void removeActiveEnemy(ActiveEnemy* e) {
-	removeMugenAnimation(e->mAnimationID);
+static void setActiveEnemy(int i, ActiveEnemy* e) {
+	gData.mActiveEnemies[i] = e;
+	e->mIndex = i;
+}
+
+static void pushActiveEnemy(ActiveEnemy* e) {
+	if (gData.mActiveEnemyAmount == gData.mActiveEnemyCapacity) {
+		gData.mActiveEnemyCapacity *= 2;
+		gData.mActiveEnemies = reallocMemory(gData.mActiveEnemies, sizeof(ActiveEnemy*) * gData.mActiveEnemyCapacity);
+	}
+
+	int i = gData.mActiveEnemyAmount++;
+	if (i > gData.mAliveEnemyAmount) {
+		setActiveEnemy(i, gData.mActiveEnemies[gData.mAliveEnemyAmount]);
+	}
+	setActiveEnemy(gData.mAliveEnemyAmount++, e);
+}
+
+static void killActiveEnemy(ActiveEnemy* e) {
+	int i = e->mIndex;
+	int last = --gData.mAliveEnemyAmount;
+	setActiveEnemy(i, gData.mActiveEnemies[last]);
+	setActiveEnemy(last, e);
+	e->mIsAlive = 0;
+}
+
+static void removeActiveEnemy(int i) {
+	ActiveEnemy* e = gData.mActiveEnemies[i];
+	if (e->mIsAlive) {
+		removeMugenAnimation(e->mAnimationID);
+		killActiveEnemy(e);
+		i = e->mIndex;
+	}
 	removeFromPhysicsHandler(e->mPhysicsID);
+	freeMemory(e);
+
+	int last = --gData.mActiveEnemyAmount;
+	if (i != last) setActiveEnemy(i, gData.mActiveEnemies[last]);
 }
 
-static void enemyHitCB(void* tCaller, void* tCollisionData) {
+static void removeActiveEnemies() {
+	while (gData.mActiveEnemyAmount) {
+		removeActiveEnemy(gData.mActiveEnemyAmount - 1);
+	}
+	gData.mIndex.mIsDirty = 1;
+}
+
+void unloadEnemies()
+{
+	removeActiveEnemies();
+	gData.mCheckpointEnemyAmount = 0;
+
+	delete_int_map(&gData.mEnemyTypes);
+	gData.mEnemyTypes = new_int_map();
+}
+
+static void resolveEnemyHit(void* tCaller, void* tCollisionData) {
 	ActiveEnemy* e = tCaller;
-	CollisionData* collisionData = tCollisionData;
+	(void)tCollisionData;
 
-	if (collisionData->mCollisionList == getPlayerCollisionList()) return;
+	if (!e->mIsAlive) return;
 	
 	e->mHealth--;
 	if (e->mHealth) return;
@@ -131,17 +259,25 @@ static void enemyHitCB(void* tCaller, void* tCollisionData) {
 	
 	addExplosionEffect(pos);
 	
-	int powerAmount = getMugenAssignmentAsIntegerValueOrDefaultWhenEmpty(e->mEnemyBase->mSmallPowerAmount, NULL, 0);
+	int powerAmount = getCompiledAssignmentAsIntegerValueOrDefaultWhenEmpty(e->mEnemyBase->mSmallPowerAmount, NULL, 0);
 	addSmallPowerItems(pos, powerAmount);
 
-	int lifeAmount = getMugenAssignmentAsIntegerValueOrDefaultWhenEmpty(e->mEnemyBase->mLifeDropAmount, NULL, 0);
+	int lifeAmount = getCompiledAssignmentAsIntegerValueOrDefaultWhenEmpty(e->mEnemyBase->mLifeDropAmount, NULL, 0);
 	addLifeItems(pos, lifeAmount);
 
-	int bombAmount = getMugenAssignmentAsIntegerValueOrDefaultWhenEmpty(e->mEnemyBase->mBombDropAmount, NULL, 0);
+	int bombAmount = getCompiledAssignmentAsIntegerValueOrDefaultWhenEmpty(e->mEnemyBase->mBombDropAmount, NULL, 0);
 	addBombItems(pos, bombAmount);
 
-	removeActiveEnemy(e);
-	list_remove(&gData.mActiveEnemies, e->mListID);
+	removeMugenAnimation(e->mAnimationID);
+	killActiveEnemy(e);
+	gData.mIndex.mIsDirty = 1;
+}
+
+static void enemyHitCB(void* tCaller, void* tCollisionData) {
+	CollisionData* collisionData = tCollisionData;
+	if (collisionData->mCollisionList == getPlayerCollisionList()) return;
+
+	addCollisionEvent(resolveEnemyHit, tCaller, tCollisionData);
 }
 
 typedef struct {
@@ -149,10 +285,24 @@ typedef struct {
 
 } EnemyAssignmentCaller;
 
-void getCurrentEnemyIndex(char* tDst, void* tCaller) {
+double getCurrentEnemyIndexValue(void* tCaller) {
 	EnemyAssignmentCaller* caller = tCaller;
 
-	sprintf(tDst, "%d", caller->i);
+	return caller->i;
+}
+
+void getCurrentEnemyIndex(char* tDst, void* tCaller) {
+	sprintf(tDst, "%d", (int)getCurrentEnemyIndexValue(tCaller));
+}
+
+static void startMovementLeg(ActiveEnemy* e, Position tTarget);
+
+static void addActiveEnemyAnimation(ActiveEnemy* e) {
+	e->mAnimationID = addMugenAnimation(getMugenAnimation(gData.mEnemyAnimations, getEnemyTypeIdleAnimation(e->mType)), gData.mEnemySprites, makePosition(0, 0, 15));
+	setMugenAnimationBasePosition(e->mAnimationID, getHandledPhysicsPositionReference(e->mPhysicsID));
+	e->mCollisionData.mCollisionList = getEnemyCollisionList();
+	e->mCollisionData.mIsItem = 0;
+	setMugenAnimationCollisionActive(e->mAnimationID, getEnemyCollisionList(), enemyHitCB, e, &e->mCollisionData);
 }
 
 static void addSingleEnemy(StageEnemy* tEnemy, int i) {
@@ -162,46 +312,75 @@ static void addSingleEnemy(StageEnemy* tEnemy, int i) {
 	ActiveEnemy* e = allocMemory(sizeof(ActiveEnemy));
 	e->mEnemyBase = tEnemy;
 	e->mType = tEnemy->mType;
-	e->mShotType = getMugenAssignmentAsIntegerValueOrDefaultWhenEmpty(tEnemy->mShotType, &caller, 0);
+	e->mShotType = getCompiledAssignmentAsIntegerValueOrDefaultWhenEmpty(tEnemy->mShotType, &caller, 0);
 	e->mShotNow = 0;
-	e->mShotFrequency = getMugenAssignmentAsFloatValueOrDefaultWhenEmpty(tEnemy->mShotFrequency, &caller, 60);
+	e->mShotFrequency = getCompiledAssignmentAsFloatValueOrDefaultWhenEmpty(tEnemy->mShotFrequency, &caller, 60);
 	e->mIsAlive = 1;
 
-	e->mStartPosition = getMugenAssignmentAsVector3DValueOrDefaultWhenEmpty(tEnemy->mStartPosition, &caller, makePosition(0, 0, 0));
+	e->mStartPosition = getCompiledAssignmentAsVector3DValueOrDefaultWhenEmpty(tEnemy->mStartPosition, &caller, makePosition(0, 0, 0));
 	e->mPhysicsID = addToPhysicsHandler(e->mStartPosition);
-	e->mSpeed = getMugenAssignmentAsFloatValueOrDefaultWhenEmpty(tEnemy->mSpeed, &caller, 1);
+	e->mSpeed = getCompiledAssignmentAsFloatValueOrDefaultWhenEmpty(tEnemy->mSpeed, &caller, 1);
 
-	e->mFinalPosition = getMugenAssignmentAsVector3DValueOrDefaultWhenEmpty(tEnemy->mFinalPosition, &caller, makePosition(0, 0, 0));
-	e->mWaitPosition = getMugenAssignmentAsVector3DValueOrDefaultWhenEmpty(tEnemy->mWaitPosition, &caller, e->mFinalPosition);
+	e->mFinalPosition = getCompiledAssignmentAsVector3DValueOrDefaultWhenEmpty(tEnemy->mFinalPosition, &caller, makePosition(0, 0, 0));
+	e->mWaitPosition = getCompiledAssignmentAsVector3DValueOrDefaultWhenEmpty(tEnemy->mWaitPosition, &caller, e->mFinalPosition);
 	e->mMovementType = tEnemy->mMovementType;
 	e->mMovementState = e->mMovementType == ENEMY_MOVEMENT_TYPE_WAIT ? ENEMY_MOVEMENT_STATE_GOTO_WAIT : ENEMY_MOVEMENT_STATE_GOTO_FINAL;
 
-	e->mWaitDuration = getMugenAssignmentAsFloatValueOrDefaultWhenEmpty(tEnemy->mWaitDuration, &caller, 120);
+	e->mWaitDuration = getCompiledAssignmentAsFloatValueOrDefaultWhenEmpty(tEnemy->mWaitDuration, &caller, 120);
+	startMovementLeg(e, e->mMovementState == ENEMY_MOVEMENT_STATE_GOTO_WAIT ? e->mWaitPosition : e->mFinalPosition);
 
-	e->mAnimationID = addMugenAnimation(getMugenAnimation(gData.mEnemyAnimations, getEnemyTypeIdleAnimation(e->mType)), gData.mEnemySprites, makePosition(0, 0, 15));
-	setMugenAnimationBasePosition(e->mAnimationID, getHandledPhysicsPositionReference(e->mPhysicsID));
-	e->mCollisionData.mCollisionList = getEnemyCollisionList();
-	e->mCollisionData.mIsItem = 0;
-	setMugenAnimationCollisionActive(e->mAnimationID, getEnemyCollisionList(), enemyHitCB, e, &e->mCollisionData);
+	addActiveEnemyAnimation(e);
 	
-	e->mHealth = getMugenAssignmentAsIntegerValueOrDefaultWhenEmpty(tEnemy->mHealth, &caller, 10);
+	e->mHealth = getCompiledAssignmentAsIntegerValueOrDefaultWhenEmpty(tEnemy->mHealth, &caller, 10);
 
-	e->mListID = list_push_back_owned(&gData.mActiveEnemies, e);
-	
+	pushActiveEnemy(e);
+	gData.mIndex.mIsDirty = 1;
 }
 
 void addEnemy(StageEnemy* tEnemy)
 {
-	int amount = getMugenAssignmentAsIntegerValueOrDefaultWhenEmpty(tEnemy->mAmount, NULL, 1);
+	int amount = getCompiledAssignmentAsIntegerValueOrDefaultWhenEmpty(tEnemy->mAmount, NULL, 1);
 	int i;
 	for (i = 0; i < amount; i++) {
 		addSingleEnemy(tEnemy, i);
 	}
 }
 
+void saveEnemyCheckpoint()
+{
+	if (gData.mActiveEnemyAmount > gData.mCheckpointEnemyCapacity) {
+		gData.mCheckpointEnemyCapacity = gData.mActiveEnemyAmount;
+		gData.mCheckpointEnemies = reallocMemory(gData.mCheckpointEnemies, sizeof(ActiveEnemy) * gData.mCheckpointEnemyCapacity);
+		gData.mCheckpointPositions = reallocMemory(gData.mCheckpointPositions, sizeof(Position) * gData.mCheckpointEnemyCapacity);
+	}
+
+	gData.mCheckpointEnemyAmount = 0;
+	int i;
+	for (i = 0; i < gData.mAliveEnemyAmount; i++) {
+		ActiveEnemy* e = gData.mActiveEnemies[i];
+		gData.mCheckpointEnemies[gData.mCheckpointEnemyAmount] = *e;
+		gData.mCheckpointPositions[gData.mCheckpointEnemyAmount] = *getHandledPhysicsPositionReference(e->mPhysicsID);
+		gData.mCheckpointEnemyAmount++;
+	}
+}
+
+void restoreEnemyCheckpoint()
+{
+	removeActiveEnemies();
+
+	int i;
+	for (i = 0; i < gData.mCheckpointEnemyAmount; i++) {
+		ActiveEnemy* e = allocMemory(sizeof(ActiveEnemy));
+		*e = gData.mCheckpointEnemies[i];
+		e->mPhysicsID = addToPhysicsHandler(gData.mCheckpointPositions[i]);
+		addActiveEnemyAnimation(e);
+		pushActiveEnemy(e);
+	}
+}
+
 int getEnemyAmount()
 {
-	return list_size(&gData.mActiveEnemies);
+	return gData.mAliveEnemyAmount;
 }
 
 typedef struct {
@@ -210,9 +389,7 @@ typedef struct {
 	int mHasFoundPosition;
 } GetClosestEnemyCaller;
 
-static void getClosestEnemyPositionCheckSingleEnemy(void* tCaller, void* tData) {
-	GetClosestEnemyCaller* caller = tCaller;
-	ActiveEnemy* e = tData;
+static void getClosestEnemyPositionCheckSingleEnemy(GetClosestEnemyCaller* caller, ActiveEnemy* e) {
 	Position p = *getHandledPhysicsPositionReference(e->mPhysicsID);
 
 	double cd = getDistance2D(caller->mPosition, caller->mClosestPosition);
@@ -223,26 +400,194 @@ static void getClosestEnemyPositionCheckSingleEnemy(void* tCaller, void* tData)
 	caller->mClosestPosition = p;
 }
 
+static Position getClosestEnemyPositionLinear(Position tPosition) {
+	GetClosestEnemyCaller caller;
+	caller.mPosition = tPosition;
+	caller.mClosestPosition = tPosition;
+	caller.mHasFoundPosition = 0;
+
+	int i;
+	for (i = 0; i < gData.mAliveEnemyAmount; i++) {
+		getClosestEnemyPositionCheckSingleEnemy(&caller, gData.mActiveEnemies[i]);
+	}
+
+	return caller.mClosestPosition;
+}
+
+static int getEnemyGridCoordinate(double tValue, int tCellAmount) {
+	int cell = (int)(tValue / ENEMY_GRID_CELL_SIZE);
+	return max(0, min(tCellAmount - 1, cell));
+}
+
+static int isInsideEnemyGrid(Position p) {
+	return p.x >= 0 && p.x < ENEMY_GRID_WIDTH * ENEMY_GRID_CELL_SIZE && p.y >= 0 && p.y < ENEMY_GRID_HEIGHT * ENEMY_GRID_CELL_SIZE;
+}
+
+static void addEnemyToSpatialIndex(ActiveEnemy* e) {
+	EnemySpatialIndex* index = &gData.mIndex;
+	if (index->mAmount >= MAX_INDEXED_ENEMY_AMOUNT) {
+		index->mHasOverflowed = 1;
+		return;
+	}
+
+	Position p = *getHandledPhysicsPositionReference(e->mPhysicsID);
+	if (!isInsideEnemyGrid(p)) {
+		index->mOutsidePositions[index->mOutsideAmount++] = p;
+		return;
+	}
+
+	int x = getEnemyGridCoordinate(p.x, ENEMY_GRID_WIDTH);
+	int y = getEnemyGridCoordinate(p.y, ENEMY_GRID_HEIGHT);
+	index->mPositions[index->mAmount] = p;
+	index->mCells[index->mAmount] = y * ENEMY_GRID_WIDTH + x;
+	index->mAmount++;
+}
+
+static void rebuildEnemySpatialIndex() {
+	EnemySpatialIndex* index = &gData.mIndex;
+	index->mAmount = 0;
+	index->mOutsideAmount = 0;
+	index->mHasOverflowed = 0;
+
+	int i;
+	for (i = 0; i < gData.mAliveEnemyAmount; i++) {
+		addEnemyToSpatialIndex(gData.mActiveEnemies[i]);
+	}
+
+	for (i = 0; i <= ENEMY_GRID_CELL_AMOUNT; i++) {
+		index->mCellStart[i] = 0;
+	}
+	for (i = 0; i < index->mAmount; i++) {
+		index->mCellStart[index->mCells[i] + 1]++;
+	}
+	for (i = 0; i < ENEMY_GRID_CELL_AMOUNT; i++) {
+		index->mCellStart[i + 1] += index->mCellStart[i];
+	}
+
+	int fill[ENEMY_GRID_CELL_AMOUNT];
+	for (i = 0; i < ENEMY_GRID_CELL_AMOUNT; i++) {
+		fill[i] = index->mCellStart[i];
+	}
+	for (i = 0; i < index->mAmount; i++) {
+		index->mCellPositions[fill[index->mCells[i]]++] = index->mPositions[i];
+	}
+
+	index->mIsDirty = 0;
+}
+
+static void checkClosestEnemyPositionInRange(GetClosestEnemyCaller* caller, double* tBestDistance, Position* tPositions, int tStart, int tEnd) {
+	int i;
+	for (i = tStart; i < tEnd; i++) {
+		double dx = tPositions[i].x - caller->mPosition.x;
+		double dy = tPositions[i].y - caller->mPosition.y;
+		double d = dx*dx + dy*dy;
+		if (caller->mHasFoundPosition && *tBestDistance < d) continue;
+
+		caller->mHasFoundPosition = 1;
+		caller->mClosestPosition = tPositions[i];
+		*tBestDistance = d;
+	}
+}
+
+static void checkClosestEnemyPositionInCell(GetClosestEnemyCaller* caller, double* tBestDistance, int x, int y) {
+	if (x < 0 || x >= ENEMY_GRID_WIDTH || y < 0 || y >= ENEMY_GRID_HEIGHT) return;
+
+	EnemySpatialIndex* index = &gData.mIndex;
+	int cell = y * ENEMY_GRID_WIDTH + x;
+	checkClosestEnemyPositionInRange(caller, tBestDistance, index->mCellPositions, index->mCellStart[cell], index->mCellStart[cell + 1]);
+}
 
 Position getClosestEnemyPosition(Position tPosition)
 {
+	EnemySpatialIndex* index = &gData.mIndex;
+	if (index->mIsDirty) rebuildEnemySpatialIndex();
+	if (index->mHasOverflowed) return getClosestEnemyPositionLinear(tPosition);
+
 	GetClosestEnemyCaller caller;
 	caller.mPosition = tPosition;
 	caller.mClosestPosition = tPosition;
 	caller.mHasFoundPosition = 0;
-	list_map(&gData.mActiveEnemies, getClosestEnemyPositionCheckSingleEnemy, &caller);
+	double bestDistance = 0;
+
+	checkClosestEnemyPositionInRange(&caller, &bestDistance, index->mOutsidePositions, 0, index->mOutsideAmount);
+	if (!index->mAmount) return caller.mClosestPosition;
+
+	// cells outside ring r are at least r cells away
+	int cx = getEnemyGridCoordinate(tPosition.x, ENEMY_GRID_WIDTH);
+	int cy = getEnemyGridCoordinate(tPosition.y, ENEMY_GRID_HEIGHT);
+	int maxRing = max(ENEMY_GRID_WIDTH, ENEMY_GRID_HEIGHT);
+	int r;
+	for (r = 0; r < maxRing; r++) {
+		if (r == 0) {
+			checkClosestEnemyPositionInCell(&caller, &bestDistance, cx, cy);
+		}
+		else {
+			int k;
+			for (k = -r; k <= r; k++) {
+				checkClosestEnemyPositionInCell(&caller, &bestDistance, cx + k, cy - r);
+				checkClosestEnemyPositionInCell(&caller, &bestDistance, cx + k, cy + r);
+			}
+			for (k = -r + 1; k <= r - 1; k++) {
+				checkClosestEnemyPositionInCell(&caller, &bestDistance, cx - r, cy + k);
+				checkClosestEnemyPositionInCell(&caller, &bestDistance, cx + r, cy + k);
+			}
+		}
+
+		double ringDistance = r * ENEMY_GRID_CELL_SIZE;
+		if (caller.mHasFoundPosition && bestDistance <= ringDistance * ringDistance) break;
+	}
 
 	return caller.mClosestPosition;
 }
 
-Position getRandomEnemyPosition()
+#define ENEMY_COLLISION_BROADPHASE_RADIUS 128
+
+void addEnemyCollisionBroadphaseTargets()
 {
-	if (!list_size(&gData.mActiveEnemies)) return makePosition(INF, INF, 0);
+	int i;
+	for (i = 0; i < gData.mAliveEnemyAmount; i++) {
+		ActiveEnemy* e = gData.mActiveEnemies[i];
+		addCollisionBroadphaseTarget(getEnemyCollisionList(), *getHandledPhysicsPositionReference(e->mPhysicsID), ENEMY_COLLISION_BROADPHASE_RADIUS);
+	}
+}
 
-	int index = randfromInteger(0, list_size(&gData.mActiveEnemies) - 1);
-	ActiveEnemy* e = list_get_by_ordered_index(&gData.mActiveEnemies, index);
+static int isEnemyInCircle(ActiveEnemy* e, Position tCenter, double tRadius) {
 	Position p = *getHandledPhysicsPositionReference(e->mPhysicsID);
-	return p;
+	double dx = p.x - tCenter.x;
+	double dy = p.y - tCenter.y;
+	return dx*dx + dy*dy <= tRadius * tRadius;
+}
+
+int getEnemyAmountInCircle(Position tCenter, double tRadius)
+{
+	int amount = 0;
+	int i;
+	for (i = 0; i < gData.mAliveEnemyAmount; i++) {
+		amount += isEnemyInCircle(gData.mActiveEnemies[i], tCenter, tRadius);
+	}
+
+	return amount;
+}
+
+void damageEnemyInCircle(Position tCenter, double tRadius, int tIndex)
+{
+	int i;
+	for (i = 0; i < gData.mAliveEnemyAmount; i++) {
+		ActiveEnemy* e = gData.mActiveEnemies[i];
+		if (!isEnemyInCircle(e, tCenter, tRadius)) continue;
+		if (tIndex--) continue;
+
+		resolveEnemyHit(e, NULL);
+		return;
+	}
+}
+
+Position getRandomEnemyPosition()
+{
+	if (!gData.mAliveEnemyAmount) return makePosition(INF, INF, 0);
+
+	ActiveEnemy* e = gData.mActiveEnemies[randfromInteger(0, gData.mAliveEnemyAmount - 1)];
+	return *getHandledPhysicsPositionReference(e->mPhysicsID);
 }
 
 static void updateEnemyShot(ActiveEnemy* e) {
@@ -252,11 +597,32 @@ static void updateEnemyShot(ActiveEnemy* e) {
 	}
 }
 
+static void startMovementLeg(ActiveEnemy* e, Position tTarget) {
+	Position start = *getHandledPhysicsPositionReference(e->mPhysicsID);
+	Vector3D delta = vecSub(tTarget, start);
+	double length = vecLength(delta);
+
+	e->mLegTarget = tTarget;
+	if (length == 0) {
+		e->mLegStep = makePosition(0, 0, 0);
+		e->mLegFramesLeft = 1;
+	}
+	else if (e->mSpeed <= 0) {
+		e->mLegStep = makePosition(0, 0, 0);
+		e->mLegFramesLeft = -1;
+	}
+	else {
+		e->mLegStep = vecScale(delta, e->mSpeed / length);
+		e->mLegFramesLeft = max(1, (int)ceil(length / e->mSpeed));
+	}
+}
+
 static void updateEnemyWait(ActiveEnemy* e) {
 	if (e->mMovementState != ENEMY_MOVEMENT_STATE_WAIT) return;
 
 	if (handleDurationAndCheckIfOver(&e->mWaitNow, e->mWaitDuration)) {
 		e->mMovementState = ENEMY_MOVEMENT_STATE_GOTO_FINAL;
+		startMovementLeg(e, e->mFinalPosition);
 	}
 }
 
@@ -264,56 +630,35 @@ static void startWait(ActiveEnemy* e) {
 	stopHandledPhysics(e->mPhysicsID);
 	e->mMovementState = ENEMY_MOVEMENT_STATE_WAIT;
 	e->mWaitNow = 0;
-	e->mStartPosition = e->mWaitPosition;
 }
 
 static void updateEnemyMovement(ActiveEnemy* e) {
 	if (e->mMovementState == ENEMY_MOVEMENT_STATE_WAIT) return;
+	if (e->mLegFramesLeft < 0) return;
+
+	Position* pos = getHandledPhysicsPositionReference(e->mPhysicsID);
+	if (--e->mLegFramesLeft) {
+		*pos = vecAdd(*pos, e->mLegStep);
+		return;
+	}
 
-	Position target;
+	*pos = e->mLegTarget;
 	if (e->mMovementState == ENEMY_MOVEMENT_STATE_GOTO_WAIT) {
-		target = e->mWaitPosition;
+		startWait(e);
 	}
 	else {
-		target = e->mFinalPosition;
-	}
-
-	Position start = e->mStartPosition;
-	Position* pos = getHandledPhysicsPositionReference(e->mPhysicsID);
-	
-	double totalLength = vecLength(vecSub(target, start));
-	double posLength = vecLength(vecSub(*pos, start));
-	double t = posLength / totalLength;
-
-	double stepSize = 1 / (totalLength / e->mSpeed);
-	
-	t = min(1, t+stepSize);
-
-	*pos = interpolatePositionLinear(start, target, t);
-	if (t >= 1)	{
-		if (e->mMovementState == ENEMY_MOVEMENT_STATE_GOTO_WAIT) {
-			startWait(e);
-			return;
-		}
-		else {
-			pos->x = -1000;
-		}
+		pos->x = -1000;
 	}
-
 }
 
-static int updateSingleActiveEnemy(void* tCaller, void* tData) {
-	(void)tCaller;
-	ActiveEnemy* e = tData;
+static int updateSingleActiveEnemy(ActiveEnemy* e) {
+	if (!e->mIsAlive) return 1;
 	
 	updateEnemyWait(e);
 	updateEnemyMovement(e);
 	
 	Position p = *getHandledPhysicsPositionReference(e->mPhysicsID);
-	if (p.x < -100) {
-		removeActiveEnemy(e);
-		return 1;
-	}
+	if (p.x < -100) return 1;
 
 	updateEnemyShot(e);
 
@@ -323,7 +668,17 @@ static int updateSingleActiveEnemy(void* tCaller, void* tData) {
 static void updateEnemyHandler(void* tData) {
 	(void)tData;
 	if (isWrapperPaused()) return;
-	list_remove_predicate(&gData.mActiveEnemies, updateSingleActiveEnemy, NULL);
+
+	int i = 0;
+	while (i < gData.mActiveEnemyAmount) {
+		if (updateSingleActiveEnemy(gData.mActiveEnemies[i])) {
+			removeActiveEnemy(i);
+		}
+		else {
+			i++;
+		}
+	}
+	rebuildEnemySpatialIndex();
 }
 
 ActorBlueprint EnemyHandler = {
@@ -6,6 +6,9 @@
 #include <tari/mugenanimationreader.h>
 #include <tari/mugenassignment.h>
 
+#include "compiledassignment.h"
+#include "bundle.h"
+
 typedef enum {
 	ENEMY_MOVEMENT_TYPE_WAIT,
 	ENEMY_MOVEMENT_TYPE_RUSH,
@@ -14,28 +17,37 @@ typedef enum {
 typedef struct {
 	int mType;
 
-	MugenAssignment* mAmount;
-	MugenAssignment* mStartPosition;
-	MugenAssignment* mWaitPosition;
-	MugenAssignment* mFinalPosition;
+	CompiledAssignment* mAmount;
+	CompiledAssignment* mStartPosition;
+	CompiledAssignment* mWaitPosition;
+	CompiledAssignment* mFinalPosition;
 	EnemyMovementType mMovementType;
-	MugenAssignment* mSpeed;
-	MugenAssignment* mSmallPowerAmount;
-	MugenAssignment* mLifeDropAmount;
-	MugenAssignment* mBombDropAmount;
+	CompiledAssignment* mSpeed;
+	CompiledAssignment* mSmallPowerAmount;
+	CompiledAssignment* mLifeDropAmount;
+	CompiledAssignment* mBombDropAmount;
 
-	MugenAssignment* mShotFrequency;
-	MugenAssignment* mShotType;
+	CompiledAssignment* mShotFrequency;
+	CompiledAssignment* mShotType;
 
-	MugenAssignment* mHealth;
-	MugenAssignment* mWaitDuration;
+	CompiledAssignment* mHealth;
+	CompiledAssignment* mWaitDuration;
 } StageEnemy;
 
 extern ActorBlueprint EnemyHandler;
 
 void loadEnemyTypesFromScript(MugenDefScript* tScript, MugenAnimations* tAnimations, MugenSpriteFile* tSprites);
+void loadEnemyTypesFromBundle(BundleReader* tReader, MugenAnimations* tAnimations, MugenSpriteFile* tSprites);
+void writeEnemyTypesToBundle(BundleWriter* tWriter);
+void unloadEnemies();
 void getCurrentEnemyIndex(char* tDst, void* tCaller);
+double getCurrentEnemyIndexValue(void* tCaller);
 void addEnemy(StageEnemy* tEnemy);
+void saveEnemyCheckpoint();
+void restoreEnemyCheckpoint();
 int getEnemyAmount();
 Position getClosestEnemyPosition(Position tPosition);
-Position getRandomEnemyPosition();
\ No newline at end of file
+Position getRandomEnemyPosition();
+int getEnemyAmountInCircle(Position tCenter, double tRadius);
+void damageEnemyInCircle(Position tCenter, double tRadius, int tIndex);
+void addEnemyCollisionBroadphaseTargets();
\ No newline at end of file
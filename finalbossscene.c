@@ -7,6 +7,7 @@
 #include <tari/timer.h>
 
 #include "shothandler.h"
+#include "assetregistry.h"
 
 static struct {
 	TextureData mWhiteTexture;
@@ -21,7 +22,7 @@ static struct {
 static void loadSceneHandler(void* tData) {
 	(void)tData;
 
-	gData.mWhiteTexture = loadTexture("$/rd/effects/white.pkg");
+	gData.mWhiteTexture = acquireTexture("$/rd/effects/white.pkg");
 
 	gData.mHasBeenShown = 0;
 	gData.mIsShowing = 0;
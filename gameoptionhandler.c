@@ -9,10 +9,9 @@
 #include <tari/screeneffect.h>
 #include <tari/mugenanimationhandler.h>
 
-#include "gamescreen.h"
 #include "titlescreen.h"
-#include "player.h"
 #include "level.h"
+#include "assetregistry.h"
 
 static struct {
 	TextureData mWhiteTexture;
@@ -35,7 +34,7 @@ static void loadGameOptionHandler(void* tData) {
 	setOptionTextSize(20);
 	setOptionTextBreakSize(-5);
 
-	gData.mWhiteTexture = loadTexture("$/rd/effects/white.pkg");
+	gData.mWhiteTexture = acquireTexture("$/rd/effects/white.pkg");
 
 	gData.mIsActive = 0;
 }
@@ -58,11 +57,10 @@ static void pickResumeOption(void* tData) {
 	setOptionsInactive();
 }
 
-static void goToStartOfGame(void* tCaller) {
+static void retryFromCheckpoint(void* tCaller) {
 	(void)tCaller;
-	resetPlayerState();
-	setLevelToStart();
-	setNewScreen(&GameScreen);
+	restoreLevelCheckpoint();
+	addFadeIn(30, NULL, NULL);
 }
 
 static void goToTitleScreen(void* tCaller) {
@@ -72,8 +70,8 @@ static void goToTitleScreen(void* tCaller) {
 
 static void pickRetryOption(void* tData) {
 	(void)tData;
-	resumeWrapper();
-	addFadeOut(30, goToStartOfGame, NULL);
+	setOptionsInactive();
+	addFadeOut(30, retryFromCheckpoint, NULL);
 }
 
 static void pickExitOption(void* tData) {
@@ -93,7 +91,7 @@ static void setOptionsActive() {
 
 	gData.mPauseTextID = addHandledText(makePosition(200, 100, 65), "PAUSE", 0, COLOR_WHITE, makePosition(40, 40, 1), makePosition(-5, -5, 0), makePosition(INF, INF, INF), INF);
 	gData.mResumeOptionID = addOption(makePosition(120, 160, 65), "RESUME SAVING THE UNIVERSE", pickResumeOption, NULL);
-	gData.mRetryOptionID = addOption(makePosition(120, 190, 65), "RETRY FROM FIRST STAGE", pickRetryOption, NULL);
+	gData.mRetryOptionID = addOption(makePosition(120, 190, 65), "RETRY FROM CHECKPOINT", pickRetryOption, NULL);
 	gData.mExitOptionID = addOption(makePosition(120, 220, 65), "EXIT TO TITLE SCREEN", pickExitOption, NULL);
 
 	gData.mIsActive = 1;
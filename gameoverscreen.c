@@ -5,6 +5,7 @@
 #include <tari/input.h>
 
 #include "titlescreen.h"
+#include "assetregistry.h"
 
 static struct {
 	TextureData mTexture;
@@ -13,7 +14,8 @@ static struct {
 } gData;
 
 static void loadGameOverScreen() {
-	gData.mTexture = loadTexture("assets/gameover/GAMEOVER.pkg");
+	resetAssetRegistry();
+	gData.mTexture = acquireTexture("assets/gameover/GAMEOVER.pkg");
 	gData.mAnimationID = playOneFrameAnimationLoop(makePosition(0,0,1), &gData.mTexture);
 	addFadeIn(30, NULL, NULL);
 }
@@ -21,12 +21,16 @@
 #include "gameoptionhandler.h"
 #include "titlescreen.h"
 #include "finalbossscene.h"
+#include "prefetch.h"
+#include "assetregistry.h"
 
 static void loadGameScreen() {
+	resetAssetRegistry();
 	instantiateActor(getMugenAnimationHandlerActorBlueprint());
 
 	
 	loadCollisions();
+	instantiateActor(CollisionEventHandler);
 	instantiateActor(AssignmentHandler);
 	instantiateActor(ContinueHandler);
 	instantiateActor(GameOptionHandler);
@@ -39,6 +43,7 @@ static void loadGameScreen() {
 	instantiateActor(ShotHandler);
 	instantiateActor(BossHandler);
 	instantiateActor(FinalBossSceneHandler);
+	instantiateActor(PrefetchHandler);
 
 	instantiateActor(LevelHandler);
 
@@ -1,11 +1,18 @@
 #include "itemhandler.h"
 
+#include <math.h>
+
 #include <tari/mugenspritefilereader.h>
 #include <tari/mugenanimationhandler.h>
 #include <tari/physicshandler.h>
 #include <tari/math.h>
 
 #include "collision.h"
+#include "assetregistry.h"
+
+#define ITEM_COALESCING_THRESHOLD 8
+#define ITEM_COALESCED_AMOUNT 5
+#define ITEM_MAX_SCALE 3
 
 typedef struct {
 	ItemType mType;
@@ -13,6 +20,7 @@ typedef struct {
 	int mAnimationID;
 	int mPhysicsID;
 	int mListID;
+	int mIsCollected;
 
 	CollisionData mCollisionData;
 } Item;
@@ -28,18 +36,25 @@ static void loadItemHandler(void* tData) {
 	(void)tData;
 
 	gData.mItems = new_list();
-	gData.mSprites = loadMugenSpriteFileWithoutPalette("assets/items/ITEMS.sff");
-	gData.mAnimations = loadMugenAnimationFile("assets/items/ITEMS.air");
+	gData.mSprites = acquireMugenSpriteFileWithoutPalette("assets/items/ITEMS.sff");
+	gData.mAnimations = acquireMugenAnimationFile("assets/items/ITEMS.air");
 }
 
 static void unloadItem(Item* e) {
-	removeMugenAnimation(e->mAnimationID);
+	if (!e->mIsCollected) {
+		removeMugenAnimation(e->mAnimationID);
+	}
 	removeFromPhysicsHandler(e->mPhysicsID);
 }
 
 static int updateSingleItem(void* tCaller, void* tData) {
 	(void)tData;
 	Item* e = tData;
+	if (e->mIsCollected) {
+		unloadItem(e);
+		return 1;
+	}
+
 	Position p = *getHandledPhysicsPositionReference(e->mPhysicsID);
 	
 	if (p.x < -100) {
@@ -52,6 +67,17 @@ static int updateSingleItem(void* tCaller, void* tData) {
 
 
 
+static int removeSingleItem(void* tCaller, void* tData) {
+	(void)tCaller;
+	unloadItem(tData);
+	return 1;
+}
+
+void removeItems()
+{
+	list_remove_predicate(&gData.mItems, removeSingleItem, NULL);
+}
+
 static void updateItemHandler(void* tData) {
 	(void)tData;
 	list_remove_predicate(&gData.mItems, updateSingleItem, NULL);
@@ -62,25 +88,37 @@ ActorBlueprint ItemHandler = {
 	.mUpdate = updateItemHandler,
 };
 
-static void itemHitCB(void* tCaller, void* tCollisionData) {
+static void resolveItemHit(void* tCaller, void* tCollisionData) {
 	(void)tCollisionData;
 	Item* e = tCaller;
-	unloadItem(e);
-	list_remove(&gData.mItems, e->mListID);
+	if (e->mIsCollected) return;
+
+	removeMugenAnimation(e->mAnimationID);
+	e->mIsCollected = 1;
 }
 
-static void addSingleItem(Position tPosition, ItemType tType, int tAnimationNumber) {
+static void itemHitCB(void* tCaller, void* tCollisionData) {
+	addCollisionEvent(resolveItemHit, tCaller, tCollisionData);
+}
+
+static void addSingleItem(Position tPosition, ItemType tType, int tAnimationNumber, int tValue) {
 	Item* e = allocMemory(sizeof(Item));
 
+	e->mIsCollected = 0;
 	e->mPhysicsID = addToPhysicsHandler(tPosition);
 	addAccelerationToHandledPhysics(e->mPhysicsID, makePosition(-2, 0, 0));
 	MugenAnimation* animation = getMugenAnimation(&gData.mAnimations, tAnimationNumber);
 	e->mAnimationID = addMugenAnimation(animation, &gData.mSprites, makePosition(0, 0, 30));
 	setMugenAnimationBasePosition(e->mAnimationID, getHandledPhysicsPositionReference(e->mPhysicsID));
+	if (tValue > 1) {
+		double scale = min(ITEM_MAX_SCALE, sqrt(tValue));
+		setMugenAnimationDrawScale(e->mAnimationID, makePosition(scale, scale, 1));
+	}
 
 	e->mCollisionData.mCollisionList = getItemCollisionList();
 	e->mCollisionData.mIsItem = 1;
 	e->mCollisionData.mItemType = tType;
+	e->mCollisionData.mItemValue = tValue;
 
 	setMugenAnimationCollisionActive(e->mAnimationID, getItemCollisionList(), itemHitCB, e, &e->mCollisionData);
 
@@ -91,13 +129,30 @@ static void addItems(Position tPosition, int tAmount, ItemType tType, int tAnima
 	int i = 0;
 	for (i = 0; i < tAmount; i++) {
 		Position p = vecAdd(tPosition, makePosition(randfrom(-10, 10), randfrom(-10, 10), 0));
-		addSingleItem(p, tType, tAnimationNumber);
+		addSingleItem(p, tType, tAnimationNumber, 1);
+	}
+}
+
+static void addCoalescedItems(Position tPosition, int tAmount, ItemType tType, int tAnimationNumber) {
+	int base = tAmount / ITEM_COALESCED_AMOUNT;
+	int remainder = tAmount % ITEM_COALESCED_AMOUNT;
+
+	int i = 0;
+	for (i = 0; i < ITEM_COALESCED_AMOUNT; i++) {
+		int value = base + (i < remainder);
+		Position p = vecAdd(tPosition, makePosition(randfrom(-20, 20), randfrom(-20, 20), 0));
+		addSingleItem(p, tType, tAnimationNumber, value);
 	}
 }
 
 void addSmallPowerItems(Position tPosition, int tAmount)
 {
-	addItems(tPosition, tAmount, ITEM_TYPE_SMALL_POWER, 1);
+	if (tAmount > ITEM_COALESCING_THRESHOLD) {
+		addCoalescedItems(tPosition, tAmount, ITEM_TYPE_SMALL_POWER, 1);
+	}
+	else {
+		addItems(tPosition, tAmount, ITEM_TYPE_SMALL_POWER, 1);
+	}
 }
 
 void addLifeItems(Position tPosition, int tAmount)
@@ -7,4 +7,5 @@ extern ActorBlueprint ItemHandler;
 
 void addSmallPowerItems(Position tPosition, int tAmount);
 void addLifeItems(Position tPosition, int tAmount);
-void addBombItems(Position tPosition, int tAmount);
\ No newline at end of file
+void addBombItems(Position tPosition, int tAmount);
+void removeItems();
\ No newline at end of file
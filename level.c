@@ -15,6 +15,11 @@
 #include "player.h"
 #include "gamescreen.h"
 #include "ui.h"
+#include "shothandler.h"
+#include "itemhandler.h"
+#include "bundle.h"
+#include "prefetch.h"
+#include "assetregistry.h"
 
 typedef struct {
 	TextureData mTextures[10];
@@ -41,27 +46,60 @@ typedef struct {
 	void* mData;
 } LevelAction;
 
+typedef struct {
+	int mActionAmount;
+	LevelAction** mActions;
+	int mCursor;
+	LevelAction* mPendingBreak;
+} LevelStagePart;
+
 static struct {
 	int mCurrentLevel;
 
 	MugenAnimations mAnimations;
 	MugenSpriteFile mSprites;
+	char mAnimationPath[1024];
+	char mSpritePath[1024];
 
 	List mStageActions;
+	int mStagePartAmount;
+	LevelStagePart* mStageParts;
 
 	Duration mTime;
 
 	int mStagePart;
+	int mIsSwappingLevel;
+
+	int mCheckpointStagePart;
+	Duration mCheckpointTime;
 } gData;
 
-static void loadSpritesAndAnimations(MugenDefScript* tScript) {
-	char* animationPath = getAllocatedMugenDefStringVariable(tScript, "Header", "animations");
-	gData.mAnimations = loadMugenAnimationFile(animationPath);
-	freeMemory(animationPath);
+typedef struct {
+	char* mAnimationPath;
+	char* mSpritePath;
+	char* mBossPath;
+	char* mBackgroundPath;
+} LevelHeader;
+
+static void loadLevelHeader(MugenDefScript* tScript, LevelHeader* oHeader) {
+	oHeader->mAnimationPath = getAllocatedMugenDefStringVariable(tScript, "Header", "animations");
+	oHeader->mSpritePath = getAllocatedMugenDefStringVariable(tScript, "Header", "sprites");
+	oHeader->mBossPath = getAllocatedMugenDefStringVariable(tScript, "Header", "boss");
+	oHeader->mBackgroundPath = getAllocatedMugenDefStringVariable(tScript, "Header", "bg");
+}
+
+static void unloadLevelHeader(LevelHeader* tHeader) {
+	freeMemory(tHeader->mAnimationPath);
+	freeMemory(tHeader->mSpritePath);
+	freeMemory(tHeader->mBossPath);
+	freeMemory(tHeader->mBackgroundPath);
+}
 
-	char* spritePath = getAllocatedMugenDefStringVariable(tScript, "Header", "sprites");
-	gData.mSprites = loadMugenSpriteFileWithoutPalette(spritePath);
-	freeMemory(spritePath);
+static void loadSpritesAndAnimations(LevelHeader* tHeader) {
+	strcpy(gData.mAnimationPath, tHeader->mAnimationPath);
+	strcpy(gData.mSpritePath, tHeader->mSpritePath);
+	gData.mAnimations = acquireMugenAnimationFile(tHeader->mAnimationPath);
+	gData.mSprites = acquireMugenSpriteFileWithoutPalette(tHeader->mSpritePath);
 }
 
 static int isStageEnemy(char* tName) {
@@ -89,18 +127,18 @@ static void loadStageEnemy(MugenDefScriptGroup* tGroup, LevelAction* tLevelActio
 	StageEnemy* e = allocMemory(sizeof(StageEnemy));
 	e->mType = getMugenDefNumberVariableAsGroup(tGroup, "id");
 	
-	fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString("position", tGroup, &e->mStartPosition, "");
-	fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString("waitposition", tGroup, &e->mWaitPosition, "");
-	fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString("waitduration", tGroup, &e->mWaitDuration, "");
-	fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString("finalposition", tGroup, &e->mFinalPosition, "");
-	fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString("speed", tGroup, &e->mSpeed, "");
-	fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString("shotfrequency", tGroup, &e->mShotFrequency, "");
-	fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString("shottype", tGroup, &e->mShotType, "");
-	fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString("health", tGroup, &e->mHealth, "");
-	fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString("smallpower", tGroup, &e->mSmallPowerAmount, "");
-	fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString("lifedrop", tGroup, &e->mLifeDropAmount, "");
-	fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString("bombdrop", tGroup, &e->mBombDropAmount, "");
-	fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString("amount", tGroup, &e->mAmount, "");
+	fetchCompiledAssignmentFromGroupAndReturnWhetherItExistsDefaultString("position", tGroup, &e->mStartPosition, "");
+	fetchCompiledAssignmentFromGroupAndReturnWhetherItExistsDefaultString("waitposition", tGroup, &e->mWaitPosition, "");
+	fetchCompiledAssignmentFromGroupAndReturnWhetherItExistsDefaultString("waitduration", tGroup, &e->mWaitDuration, "");
+	fetchCompiledAssignmentFromGroupAndReturnWhetherItExistsDefaultString("finalposition", tGroup, &e->mFinalPosition, "");
+	fetchCompiledAssignmentFromGroupAndReturnWhetherItExistsDefaultString("speed", tGroup, &e->mSpeed, "");
+	fetchCompiledAssignmentFromGroupAndReturnWhetherItExistsDefaultString("shotfrequency", tGroup, &e->mShotFrequency, "");
+	fetchCompiledAssignmentFromGroupAndReturnWhetherItExistsDefaultString("shottype", tGroup, &e->mShotType, "");
+	fetchCompiledAssignmentFromGroupAndReturnWhetherItExistsDefaultString("health", tGroup, &e->mHealth, "");
+	fetchCompiledAssignmentFromGroupAndReturnWhetherItExistsDefaultString("smallpower", tGroup, &e->mSmallPowerAmount, "");
+	fetchCompiledAssignmentFromGroupAndReturnWhetherItExistsDefaultString("lifedrop", tGroup, &e->mLifeDropAmount, "");
+	fetchCompiledAssignmentFromGroupAndReturnWhetherItExistsDefaultString("bombdrop", tGroup, &e->mBombDropAmount, "");
+	fetchCompiledAssignmentFromGroupAndReturnWhetherItExistsDefaultString("amount", tGroup, &e->mAmount, "");
 
 	loadStageEnemyMovementType(e, tGroup);
 	
@@ -172,43 +210,343 @@ static void loadStageEnemiesFromScript(MugenDefScript* tScript) {
 
 }
 
-static void loadBoss(MugenDefScript* tScript) {
-	char* defPath = getAllocatedMugenDefStringVariable(tScript, "Header", "boss");
-	loadBossFromDefinitionPath(defPath, &gData.mAnimations, &gData.mSprites);
-	freeMemory(defPath);
+static void loadBoss(LevelHeader* tHeader) {
+	loadBossFromDefinitionPath(tHeader->mBossPath, &gData.mAnimations, &gData.mSprites);
 }
 
-static void loadStage(MugenDefScript* tScript) {
-	char* defPath = getAllocatedMugenDefStringVariable(tScript, "Header", "bg");
-	setBackground(defPath, &gData.mSprites);
-	freeMemory(defPath);
+static void loadStage(LevelHeader* tHeader) {
+	setBackground(tHeader->mBackgroundPath, &gData.mSprites);
 }
 
-static void loadLevelHandler(void* tData) {
-	(void)tData;
-	gData.mStageActions = new_list();
+static void writeStageEnemyToBundle(BundleWriter* tWriter, StageEnemy* e) {
+	writeBundleInteger(tWriter, e->mType);
+	writeCompiledAssignmentToBundle(tWriter, e->mStartPosition);
+	writeCompiledAssignmentToBundle(tWriter, e->mWaitPosition);
+	writeCompiledAssignmentToBundle(tWriter, e->mWaitDuration);
+	writeCompiledAssignmentToBundle(tWriter, e->mFinalPosition);
+	writeCompiledAssignmentToBundle(tWriter, e->mSpeed);
+	writeCompiledAssignmentToBundle(tWriter, e->mShotFrequency);
+	writeCompiledAssignmentToBundle(tWriter, e->mShotType);
+	writeCompiledAssignmentToBundle(tWriter, e->mHealth);
+	writeCompiledAssignmentToBundle(tWriter, e->mSmallPowerAmount);
+	writeCompiledAssignmentToBundle(tWriter, e->mLifeDropAmount);
+	writeCompiledAssignmentToBundle(tWriter, e->mBombDropAmount);
+	writeCompiledAssignmentToBundle(tWriter, e->mAmount);
+	writeBundleInteger(tWriter, e->mMovementType);
+}
 
-	char path[1024];
+static StageEnemy* readStageEnemyFromBundle(BundleReader* tReader) {
+	StageEnemy* e = allocMemory(sizeof(StageEnemy));
+	e->mType = readBundleInteger(tReader);
+	e->mStartPosition = readCompiledAssignmentFromBundle(tReader);
+	e->mWaitPosition = readCompiledAssignmentFromBundle(tReader);
+	e->mWaitDuration = readCompiledAssignmentFromBundle(tReader);
+	e->mFinalPosition = readCompiledAssignmentFromBundle(tReader);
+	e->mSpeed = readCompiledAssignmentFromBundle(tReader);
+	e->mShotFrequency = readCompiledAssignmentFromBundle(tReader);
+	e->mShotType = readCompiledAssignmentFromBundle(tReader);
+	e->mHealth = readCompiledAssignmentFromBundle(tReader);
+	e->mSmallPowerAmount = readCompiledAssignmentFromBundle(tReader);
+	e->mLifeDropAmount = readCompiledAssignmentFromBundle(tReader);
+	e->mBombDropAmount = readCompiledAssignmentFromBundle(tReader);
+	e->mAmount = readCompiledAssignmentFromBundle(tReader);
+	e->mMovementType = readBundleInteger(tReader);
+	return e;
+}
+
+static void writeSingleLevelActionToBundle(void* tCaller, void* tData) {
+	BundleWriter* writer = tCaller;
+	LevelAction* e = tData;
+
+	writeBundleInteger(writer, e->mType);
+	writeBundleInteger(writer, e->mStagePart);
+	writeBundleInteger(writer, (int)e->mTime);
+	if (e->mType == LEVEL_ACTION_TYPE_ENEMY) {
+		writeStageEnemyToBundle(writer, e->mData);
+	}
+}
+
+static void writeLevelBundle(char* tPath, char* tBundlePath, LevelHeader* tHeader) {
+	BundleWriter writer;
+	openBundleForWriting(&writer, "stage", tPath);
+	writeBundleString(&writer, tHeader->mAnimationPath);
+	writeBundleString(&writer, tHeader->mSpritePath);
+	writeBundleString(&writer, tHeader->mBossPath);
+	writeBundleString(&writer, tHeader->mBackgroundPath);
+	writeEnemyTypesToBundle(&writer);
+	writeBundleInteger(&writer, list_size(&gData.mStageActions));
+	list_map(&gData.mStageActions, writeSingleLevelActionToBundle, &writer);
+	saveBundleAndClose(&writer, tBundlePath);
+}
+
+static void readLevelActionsFromBundle(BundleReader* tReader) {
+	int amount = readBundleInteger(tReader);
+	int i;
+	for (i = 0; i < amount && !tReader->mHasFailed; i++) {
+		LevelAction* e = allocMemory(sizeof(LevelAction));
+		e->mHasBeenActivated = 0;
+		e->mType = readBundleInteger(tReader);
+		e->mStagePart = readBundleInteger(tReader);
+		e->mTime = readBundleInteger(tReader);
+		e->mData = e->mType == LEVEL_ACTION_TYPE_ENEMY ? readStageEnemyFromBundle(tReader) : NULL;
+		list_push_back_owned(&gData.mStageActions, e);
+	}
+}
+
+static int loadLevelFromBundle(char* tPath, char* tBundlePath) {
+	BundleReader reader;
+	if (!openBundleForReading(&reader, tBundlePath, "stage", tPath)) return 0;
+
+	LevelHeader header;
+	header.mAnimationPath = readAllocatedBundleString(&reader);
+	header.mSpritePath = readAllocatedBundleString(&reader);
+	header.mBossPath = readAllocatedBundleString(&reader);
+	header.mBackgroundPath = readAllocatedBundleString(&reader);
+
+	loadSpritesAndAnimations(&header);
+	loadEnemyTypesFromBundle(&reader, &gData.mAnimations, &gData.mSprites);
+	readLevelActionsFromBundle(&reader);
+	if (!closeBundleAndReturnWhetherItWasValid(&reader)) {
+		logError("Corrupt stage bundle");
+		logErrorString(tBundlePath);
+		abortSystem();
+	}
+
+	loadBoss(&header);
+	loadStage(&header);
+	unloadLevelHeader(&header);
+	return 1;
+}
+
+static void parseLevelDefinitionFile(char* tPath, char* tBundlePath, LevelHeader* oHeader) {
+	char loadPath[1024];
+	getPrefetchedFilePath(loadPath, tPath);
+	MugenDefScript script = loadMugenDefScript(loadPath);
+	loadLevelHeader(&script, oHeader);
+
+	loadSpritesAndAnimations(oHeader);
+	loadEnemyTypesFromScript(&script, &gData.mAnimations, &gData.mSprites);
+	loadStageEnemiesFromScript(&script);
+	unloadMugenDefScript(script);
+
+	if (isBundleCompilationActive()) {
+		writeLevelBundle(tPath, tBundlePath, oHeader);
+	}
+}
+
+static void loadLevelFromDefinitionFile(char* tPath, char* tBundlePath) {
+	LevelHeader header;
+	parseLevelDefinitionFile(tPath, tBundlePath, &header);
+
+	loadBoss(&header);
+	loadStage(&header);
+	unloadLevelHeader(&header);
+}
+
+static void countStagePartActions(void* tCaller, void* tData) {
+	(void)tCaller;
+	LevelAction* e = tData;
+
+	gData.mStagePartAmount = max(gData.mStagePartAmount, e->mStagePart + 1);
+	gData.mStageParts[e->mStagePart].mActionAmount++;
+}
 
+static void addActionToStagePart(void* tCaller, void* tData) {
+	(void)tCaller;
+	LevelAction* e = tData;
+
+	LevelStagePart* part = &gData.mStageParts[e->mStagePart];
+	part->mActions[part->mCursor++] = e;
+}
+
+static int isLevelActionBefore(LevelAction* a, LevelAction* b) {
+	return a->mTime < b->mTime;
+}
+
+static void sortStagePartActions(LevelStagePart* tPart) {
+	// stable, so actions with the same time keep their script order
+	int i;
+	for (i = 1; i < tPart->mActionAmount; i++) {
+		LevelAction* e = tPart->mActions[i];
+		int j = i;
+		while (j > 0 && isLevelActionBefore(e, tPart->mActions[j - 1])) {
+			tPart->mActions[j] = tPart->mActions[j - 1];
+			j--;
+		}
+		tPart->mActions[j] = e;
+	}
+}
+
+static void compileStageParts() {
+	int maxPartAmount = list_size(&gData.mStageActions) + 1;
+	gData.mStageParts = allocMemory(sizeof(LevelStagePart) * maxPartAmount);
+	memset(gData.mStageParts, 0, sizeof(LevelStagePart) * maxPartAmount);
+	gData.mStagePartAmount = 0;
+	list_map(&gData.mStageActions, countStagePartActions, NULL);
+
+	int i;
+	for (i = 0; i < gData.mStagePartAmount; i++) {
+		gData.mStageParts[i].mActions = allocMemory(sizeof(LevelAction*) * max(1, gData.mStageParts[i].mActionAmount));
+	}
+	list_map(&gData.mStageActions, addActionToStagePart, NULL);
+
+	for (i = 0; i < gData.mStagePartAmount; i++) {
+		sortStagePartActions(&gData.mStageParts[i]);
+		gData.mStageParts[i].mCursor = 0;
+		gData.mStageParts[i].mPendingBreak = NULL;
+	}
+}
+
+static void getLevelDefinitionPath(char* tDst, int tLevel) {
 // TODO: more elegant
 #ifdef DREAMCAST
-    sprintf(path, "assets/stage/dc/%d.def", gData.mCurrentLevel);
+    sprintf(tDst, "assets/stage/dc/%d.def", tLevel);
 #else
-	sprintf(path, "assets/stage/%d.def", gData.mCurrentLevel);
+	sprintf(tDst, "assets/stage/%d.def", tLevel);
 #endif
-	MugenDefScript script = loadMugenDefScript(path);
+}
 
-	loadSpritesAndAnimations(&script);
-	loadEnemyTypesFromScript(&script, &gData.mAnimations, &gData.mSprites);
-	loadStageEnemiesFromScript(&script);
-	loadBoss(&script);
-	loadStage(&script);
-	unloadMugenDefScript(script);
+static void saveLevelCheckpoint() {
+	gData.mCheckpointStagePart = gData.mStagePart;
+	gData.mCheckpointTime = gData.mTime;
+	savePlayerCheckpoint();
+	saveEnemyCheckpoint();
+	saveBossCheckpoint();
+}
+
+static void loadCurrentLevel() {
+	gData.mStageActions = new_list();
+
+	char path[1024];
+	getLevelDefinitionPath(path, gData.mCurrentLevel);
+	char bundlePath[1024];
+	getBundlePathFromDefinitionPath(bundlePath, path);
+	if (!loadLevelFromBundle(path, bundlePath)) {
+		loadLevelFromDefinitionFile(path, bundlePath);
+	}
+	clearPrefetchedFiles();
+	compileStageParts();
 
 	loadStageDisplay(&gData.mSprites);
 
 	gData.mStagePart = 0;
 	gData.mTime = 0;
+	saveLevelCheckpoint();
+}
+
+static void loadLevelHandler(void* tData) {
+	(void)tData;
+	gData.mIsSwappingLevel = 0;
+	loadCurrentLevel();
+}
+
+static void unloadStageEnemy(StageEnemy* e) {
+	destroyCompiledAssignment(e->mStartPosition);
+	destroyCompiledAssignment(e->mWaitPosition);
+	destroyCompiledAssignment(e->mWaitDuration);
+	destroyCompiledAssignment(e->mFinalPosition);
+	destroyCompiledAssignment(e->mSpeed);
+	destroyCompiledAssignment(e->mShotFrequency);
+	destroyCompiledAssignment(e->mShotType);
+	destroyCompiledAssignment(e->mHealth);
+	destroyCompiledAssignment(e->mSmallPowerAmount);
+	destroyCompiledAssignment(e->mLifeDropAmount);
+	destroyCompiledAssignment(e->mBombDropAmount);
+	destroyCompiledAssignment(e->mAmount);
+	freeMemory(e);
+}
+
+static void unloadSingleLevelAction(void* tCaller, void* tData) {
+	(void)tCaller;
+	LevelAction* e = tData;
+	if (e->mType == LEVEL_ACTION_TYPE_ENEMY) {
+		unloadStageEnemy(e->mData);
+	}
+}
+
+static void unloadCurrentLevel() {
+	unloadStageDisplay();
+	unloadBackground();
+	unloadBoss();
+	unloadEnemies();
+	removeEnemyShots();
+
+	list_map(&gData.mStageActions, unloadSingleLevelAction, NULL);
+	delete_list(&gData.mStageActions);
+
+	int i;
+	for (i = 0; i < gData.mStagePartAmount; i++) {
+		freeMemory(gData.mStageParts[i].mActions);
+	}
+	freeMemory(gData.mStageParts);
+
+	releaseMugenSpriteFile(gData.mSpritePath);
+	releaseMugenAnimationFile(gData.mAnimationPath);
+}
+
+static void compileLevelBundle(char* tPath, char* tBundlePath) {
+	gData.mStageActions = new_list();
+
+	LevelHeader header;
+	parseLevelDefinitionFile(tPath, tBundlePath, &header);
+	loadBoss(&header);
+	unloadLevelHeader(&header);
+
+	unloadBoss();
+	unloadEnemies();
+	list_map(&gData.mStageActions, unloadSingleLevelAction, NULL);
+	delete_list(&gData.mStageActions);
+
+	releaseMugenSpriteFile(gData.mSpritePath);
+	releaseMugenAnimationFile(gData.mAnimationPath);
+}
+
+void compileLevelBundles()
+{
+	int level;
+	for (level = 1; ; level++) {
+		char path[1024];
+		getLevelDefinitionPath(path, level);
+		if (!isFile(path)) break;
+
+		char bundlePath[1024];
+		getBundlePathFromDefinitionPath(bundlePath, path);
+		compileLevelBundle(path, bundlePath);
+	}
+}
+
+static void swapToNextLevel() {
+	gData.mIsSwappingLevel = 0;
+	unloadCurrentLevel();
+
+	gData.mCurrentLevel++;
+	resetPlayerForNextStage();
+	loadCurrentLevel();
+}
+
+static void resetStagePart(LevelStagePart* tPart) {
+	int i;
+	for (i = 0; i < tPart->mActionAmount; i++) {
+		tPart->mActions[i]->mHasBeenActivated = 0;
+	}
+	tPart->mCursor = 0;
+	tPart->mPendingBreak = NULL;
+}
+
+static void restoreCheckpoint() {
+	removeEnemyShots();
+	removeItems();
+	restoreEnemyCheckpoint();
+	restoreBossCheckpoint();
+	restorePlayerCheckpoint();
+
+	// parts only move forward, so nothing from the checkpoint part onwards has run yet at that point
+	int i;
+	for (i = gData.mCheckpointStagePart; i < gData.mStagePartAmount; i++) {
+		resetStagePart(&gData.mStageParts[i]);
+	}
+	gData.mStagePart = gData.mCheckpointStagePart;
+	gData.mTime = gData.mCheckpointTime;
 }
 
 static void updateTime() {
@@ -232,13 +570,23 @@ static void updateBoss(LevelAction* tLevelAction) {
 static void increaseStagePart() {
 	gData.mStagePart++;
 	gData.mTime = 0;
+	saveLevelCheckpoint();
 }
 
-static void updateSingleBreak(LevelAction* tLevelAction) {
-	if (getEnemyAmount()) return;
+static void updateSingleBreak(LevelAction* tLevelAction, LevelStagePart* tPart) {
+	// actions after the break keep running until it fires, as the break only waits for the enemies
+	if (tPart->mPendingBreak) return;
+	tPart->mPendingBreak = tLevelAction;
+}
 
-	tLevelAction->mHasBeenActivated = 1;
+static int updatePendingBreak(LevelStagePart* tPart) {
+	if (!tPart->mPendingBreak) return 0;
+	if (getEnemyAmount()) return 0;
+
+	tPart->mPendingBreak->mHasBeenActivated = 1;
+	tPart->mPendingBreak = NULL;
 	increaseStagePart();
+	return 1;
 }
 
 static void updateLocalCounterReset(LevelAction* tLevelAction) {
@@ -246,21 +594,14 @@ static void updateLocalCounterReset(LevelAction* tLevelAction) {
 	resetLocalPlayerCounts();
 }
 
-static void updateSingleAction(void* tCaller, void* tData) {
-	(void)tCaller;
-	LevelAction* e = tData;
-
-	if (e->mHasBeenActivated) return;
-	if (e->mStagePart != gData.mStagePart) return;
-	if (!isDurationOver(gData.mTime, e->mTime)) return;
-	
+static void updateSingleAction(LevelAction* e, LevelStagePart* tPart) {
 	if (e->mType == LEVEL_ACTION_TYPE_ENEMY) {
 		updateSingleStageEnemy(e);
 	} else if (e->mType == LEVEL_ACTION_TYPE_BOSS) {
 		updateBoss(e);
 	}
 	else if (e->mType == LEVEL_ACTION_TYPE_BREAK) {
-		updateSingleBreak(e);
+		updateSingleBreak(e, tPart);
 	}
 	else if (e->mType == LEVEL_ACTION_TYPE_RESET_LOCAL_COUNTERS) {
 		updateLocalCounterReset(e);
@@ -273,11 +614,25 @@ static void updateSingleAction(void* tCaller, void* tData) {
 }
 
 static void updateActions() {
-	list_map(&gData.mStageActions, updateSingleAction, NULL);
+	while (gData.mStagePart < gData.mStagePartAmount) {
+		LevelStagePart* part = &gData.mStageParts[gData.mStagePart];
+		if (updatePendingBreak(part)) continue;
+		if (part->mCursor >= part->mActionAmount) return;
+
+		LevelAction* e = part->mActions[part->mCursor];
+		if (!isDurationOver(gData.mTime, e->mTime)) return;
+		part->mCursor++;
+		updateSingleAction(e, part);
+	}
 }
 
 static void updateLevelHandler(void* tData) {
 	(void)tData;
+	if (gData.mIsSwappingLevel) {
+		swapToNextLevel();
+		return;
+	}
+
 	updateTime();
 	updateActions();
 }
@@ -292,19 +647,89 @@ void setLevelToStart()
 	gData.mCurrentLevel = 1;
 }
 
+static void prefetchNextLevelAssets(LevelHeader* tHeader) {
+	char bossBundlePath[1024];
+	getBundlePathFromDefinitionPath(bossBundlePath, tHeader->mBossPath);
+	if (isFile(bossBundlePath)) prefetchFile(bossBundlePath, NULL, NULL);
+	else prefetchFile(tHeader->mBossPath, NULL, NULL);
+
+	prefetchFile(tHeader->mSpritePath, NULL, NULL);
+	prefetchFile(tHeader->mAnimationPath, NULL, NULL);
+}
+
+static void prefetchNextLevelAssetsFromBundle(void* tCaller, Buffer tBuffer) {
+	(void)tCaller;
+
+	BundleReader reader;
+	if (!openBundleForReadingFromBuffer(&reader, tBuffer, "stage")) return;
+
+	LevelHeader header;
+	header.mAnimationPath = readAllocatedBundleString(&reader);
+	header.mSpritePath = readAllocatedBundleString(&reader);
+	header.mBossPath = readAllocatedBundleString(&reader);
+	header.mBackgroundPath = readAllocatedBundleString(&reader);
+	freeBuffer(reader.mBuffer);
+
+	if (!reader.mHasFailed) {
+		prefetchNextLevelAssets(&header);
+	}
+
+	unloadLevelHeader(&header);
+}
+
+// parses the prefetched copy, so the only cost is the parse of a few KB of text
+static void prefetchNextLevelAssetsFromDefinitionFile(void* tCaller, Buffer tBuffer) {
+	char* path = tCaller;
+	(void)tBuffer;
+
+	char loadPath[1024];
+	getPrefetchedFilePath(loadPath, path);
+	MugenDefScript script = loadMugenDefScript(loadPath);
+	LevelHeader header;
+	loadLevelHeader(&script, &header);
+	unloadMugenDefScript(script);
+
+	prefetchNextLevelAssets(&header);
+	unloadLevelHeader(&header);
+}
+
+void prefetchNextLevel()
+{
+	if (isBundleCompilationActive()) return;
+
+	static char path[1024];
+	char bundlePath[1024];
+	getLevelDefinitionPath(path, gData.mCurrentLevel + 1);
+	getBundlePathFromDefinitionPath(bundlePath, path);
+	if (isFile(bundlePath)) prefetchFile(bundlePath, prefetchNextLevelAssetsFromBundle, NULL);
+	else prefetchFile(path, prefetchNextLevelAssetsFromDefinitionFile, path);
+}
+
 void goToNextLevel()
 {
-	gData.mCurrentLevel++;
-	setNewScreen(&GameScreen);
+	// deferred, since this is reached from the boss collision callback
+	gData.mIsSwappingLevel = 1;
 }
 
 void fetchStagePartTime(char * tDst, void * tCaller)
 {
 	(void)tCaller;
-	sprintf(tDst, "%d", (int)gData.mTime);
+	sprintf(tDst, "%d", getStagePartTime());
+}
+
+int getStagePartTime()
+{
+	return (int)gData.mTime;
 }
 
 void advanceStagePart()
 {
 	gData.mStagePart++;
+	saveLevelCheckpoint();
+}
+
+void restoreLevelCheckpoint()
+{
+	if (gData.mIsSwappingLevel) return;
+	restoreCheckpoint();
 }
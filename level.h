@@ -5,6 +5,10 @@
 extern ActorBlueprint LevelHandler;
 
 void setLevelToStart();
+void compileLevelBundles();
+void prefetchNextLevel();
 void goToNextLevel();
 void fetchStagePartTime(char* tDst, void* tCaller);
-void advanceStagePart();
\ No newline at end of file
+int getStagePartTime();
+void advanceStagePart();
+void restoreLevelCheckpoint();
\ No newline at end of file
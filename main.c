@@ -13,6 +13,7 @@
 #include "level.h"
 #include "titlescreen.h"
 #include "storyscreen.h"
+#include "bundlecompiler.h"
 
 #ifdef DREAMCAST
 KOS_INIT_FLAGS(INIT_DEFAULT);
@@ -27,7 +28,7 @@ KOS_INIT_ROMDISK(romdisk);
 void exitGame() {
 	shutdownTariWrapper();
 
-#ifdef DEVELOP
+#if defined(DEVELOP) || defined(BUNDLE_COMPILER)
 	abortSystem();
 #else
 	returnToMenu();
@@ -35,7 +36,7 @@ void exitGame() {
 }
 
 void setMainFileSystem() {
-#ifdef DEVELOP
+#if defined(DEVELOP) || defined(BUNDLE_COMPILER)
 	setFileSystem("/pc");
 #else
 	setFileSystem("/cd");
@@ -52,6 +53,10 @@ int main(int argc, char** argv) {
 	initTariWrapperWithDefaultFlags();
 	setFont("$/rd/fonts/segoe.hdr", "$/rd/fonts/segoe.pkg");
 
+#ifdef BUNDLE_COMPILER
+	setMainFileSystem();
+	startScreenHandling(&BundleCompilerScreen);
+#else
 	logg("Check framerate");
 	FramerateSelectReturnType framerateReturnType = selectFramerate();
 	if (framerateReturnType == FRAMERATE_SCREEN_RETURN_ABORT) {
@@ -62,6 +67,7 @@ int main(int argc, char** argv) {
 	
 	setScreenAfterWrapperLogoScreen(&TitleScreen);
 	startScreenHandling(getLogoScreenFromWrapper());
+#endif
 
 	exitGame();
 
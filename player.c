@@ -19,6 +19,19 @@
 #include "continuehandler.h"
 #include "gameoverscreen.h"
 #include "boss.h"
+#include "assetregistry.h"
+
+#define PLAYER_HITBOX_RADIUS 2
+
+typedef struct {
+	Position mPosition;
+	int mPower;
+	int mLifeAmount;
+	int mBombAmount;
+	int mLocalBombCount;
+	int mLocalDeathCount;
+	int mCanBeHitByEnemies;
+} PlayerCheckpoint;
 
 static struct {
 	MugenSpriteFile mSprites;
@@ -69,6 +82,8 @@ static struct {
 	Duration mIsHitDuration;
 
 	int mCanBeHitByEnemies;
+
+	PlayerCheckpoint mCheckpoint;
 } gData;
 
 static void playerHitCB(void* tCaller, void* tCollisionData);
@@ -79,8 +94,8 @@ static void loadPlayer(void* tData) {
 	setBombText(gData.mBombAmount);
 	setPowerText(gData.mPower);
 
-	gData.mSprites = loadMugenSpriteFileWithoutPalette("assets/player/PLAYER.sff");
-	gData.mAnimations = loadMugenAnimationFile("assets/player/PLAYER.air");
+	gData.mSprites = acquireMugenSpriteFileWithoutPalette("assets/player/PLAYER.sff");
+	gData.mAnimations = acquireMugenAnimationFile("assets/player/PLAYER.air");
 
 	gData.mPhysicsID = addToPhysicsHandler(makePosition(40, 200, 0));
 	setHandledPhysicsDragCoefficient(gData.mPhysicsID, makePosition(1, 1, 0));
@@ -89,13 +104,13 @@ static void loadPlayer(void* tData) {
 	setMugenAnimationBasePosition(gData.mAnimationID, getHandledPhysicsPositionReference(gData.mPhysicsID));
 
 	gData.mCollisionData.mCollisionList = getPlayerCollisionList();
-	gData.mCollider = makeColliderFromCirc(makeCollisionCirc(makePosition(0, 0, 0), 2));
+	gData.mCollider = makeColliderFromCirc(makeCollisionCirc(makePosition(0, 0, 0), PLAYER_HITBOX_RADIUS));
 	gData.mCollisionID = addColliderToCollisionHandler(getPlayerCollisionList(), getHandledPhysicsPositionReference(gData.mPhysicsID), gData.mCollider, playerHitCB, NULL, &gData.mCollisionData);
 
 	gData.mItemCollider = makeColliderFromCirc(makeCollisionCirc(makePosition(0, 0, 0), 40));
 	gData.mItemCollisionID = addColliderToCollisionHandler(getPlayerItemCollisionList(), getHandledPhysicsPositionReference(gData.mPhysicsID), gData.mItemCollider, playerHitCB, NULL, &gData.mCollisionData);
 	
-	gData.mHitboxTexture = loadTexture("assets/debug/collision_circ.pkg");
+	gData.mHitboxTexture = acquireTexture("assets/debug/collision_circ.pkg");
 	gData.mHitBoxAnimationID = playOneFrameAnimationLoop(makePosition(-8, -8, 35), &gData.mHitboxTexture);
 	setAnimationBasePositionReference(gData.mHitBoxAnimationID, getHandledPhysicsPositionReference(gData.mPhysicsID));
 	setAnimationSize(gData.mHitBoxAnimationID, makePosition(4, 4, 0), makePosition(8, 8, 0));
@@ -190,14 +205,13 @@ static void updateShot() {
 static void updateBomb() {
 	if (gData.mIsBombing) {
 		removeEnemyShots();
-		Position p = *getHandledPhysicsPositionReference(gData.mPhysicsID);
-		addShot(20, getPlayerShotCollisionList(), p);
 		if (gData.mIsFinalBossBombing) {
 			addFinalBossShot(50);
 		}
 
 		if (handleDurationAndCheckIfOver(&gData.mBombNow, gData.mBombDuration)) {
 			gData.mIsBombing = 0;
+			stopBombField();
 			if (gData.mIsFinalBossBombing) {
 				setFinalBossVulnerable();
 			}
@@ -215,6 +229,7 @@ static void updateBomb() {
 		gData.mIsBombing = 1;
 		gData.mBombNow = 0;
 		gData.mIsDying = 0;
+		startBombField(getHandledPhysicsPositionReference(gData.mPhysicsID));
 
 		gData.mIsFinalBossBombing = !isSecondPort;
 		if (gData.mIsFinalBossBombing) {
@@ -243,8 +258,8 @@ static void updateDying() {
 	}
 }
 
-static void handleSmallPowerItemCollection() {
-	gData.mPower = min(400, gData.mPower + 1);
+static void handleSmallPowerItemCollection(int tValue) {
+	gData.mPower = min(400, gData.mPower + tValue);
 	setPowerText(gData.mPower);
 }
 
@@ -277,7 +292,7 @@ static void handleBombItemCollection() {
 
 static void handleItemCollection(CollisionData* tCollisionData) {
 	if (tCollisionData->mItemType == ITEM_TYPE_SMALL_POWER) {
-		handleSmallPowerItemCollection();
+		handleSmallPowerItemCollection(tCollisionData->mItemValue);
 	} else if (tCollisionData->mItemType == ITEM_TYPE_LIFE) {
 		handleLifeItemCollection();
 	}
@@ -347,6 +362,19 @@ static void playerHitCB(void* tCaller, void* tCollisionData) {
 	gData.mDyingNow = 0;
 }
 
+void hitPlayerWithEnemyShot()
+{
+	CollisionData collisionData;
+	collisionData.mCollisionList = getEnemyShotCollisionList();
+	collisionData.mIsItem = 0;
+	playerHitCB(NULL, &collisionData);
+}
+
+double getPlayerHitboxRadius()
+{
+	return PLAYER_HITBOX_RADIUS;
+}
+
 Position getPlayerPosition()
 {
 	return *getHandledPhysicsPositionReference(gData.mPhysicsID);
@@ -381,6 +409,12 @@ void resetLocalPlayerCounts()
 	gData.mLocalDeathCount = 0;
 }
 
+void resetPlayerForNextStage()
+{
+	resetLocalPlayerCounts();
+	gData.mCanBeHitByEnemies = 1;
+}
+
 void getLocalDeathCountVariable(char * tDst, void * tCaller)
 {
 	(void)tCaller;
@@ -393,6 +427,16 @@ void getLocalBombCountVariable(char * tDst, void * tCaller)
 	sprintf(tDst, "%d", gData.mLocalBombCount);
 }
 
+int getLocalDeathCount()
+{
+	return gData.mLocalDeathCount;
+}
+
+int getLocalBombCount()
+{
+	return gData.mLocalBombCount;
+}
+
 void setPlayerToFullPower()
 {
 	gData.mPower = 400;
@@ -413,6 +457,39 @@ void reduceContinueAmount()
 	gData.mContinueAmount--;
 }
 
+void savePlayerCheckpoint()
+{
+	PlayerCheckpoint* e = &gData.mCheckpoint;
+	e->mPosition = *getHandledPhysicsPositionReference(gData.mPhysicsID);
+	e->mPower = gData.mPower;
+	e->mLifeAmount = gData.mLifeAmount;
+	e->mBombAmount = gData.mBombAmount;
+	e->mLocalBombCount = gData.mLocalBombCount;
+	e->mLocalDeathCount = gData.mLocalDeathCount;
+	e->mCanBeHitByEnemies = gData.mCanBeHitByEnemies;
+}
+
+void restorePlayerCheckpoint()
+{
+	PlayerCheckpoint* e = &gData.mCheckpoint;
+	*getHandledPhysicsPositionReference(gData.mPhysicsID) = e->mPosition;
+	stopHandledPhysics(gData.mPhysicsID);
+
+	gData.mPower = e->mPower;
+	gData.mLifeAmount = e->mLifeAmount;
+	gData.mBombAmount = e->mBombAmount;
+	gData.mLocalBombCount = e->mLocalBombCount;
+	gData.mLocalDeathCount = e->mLocalDeathCount;
+	gData.mCanBeHitByEnemies = e->mCanBeHitByEnemies;
+	setPowerText(gData.mPower);
+	setLifeText(gData.mLifeAmount);
+	setBombText(gData.mBombAmount);
+
+	gData.mIsBombing = 0;
+	gData.mIsDying = 0;
+	stopBombField();
+}
+
 void disablePlayerBossCollision()
 {
 	gData.mCanBeHitByEnemies = 0;
@@ -7,17 +7,25 @@
 extern ActorBlueprint Player;
 
 Position getPlayerPosition();
+double getPlayerHitboxRadius();
+void hitPlayerWithEnemyShot();
 PhysicsObject* getPlayerPhysics();
 double getPlayerAcceleration();
 double getPlayerSpeed();
 
 void resetPlayerState();
 void resetLocalPlayerCounts();
+void resetPlayerForNextStage();
 void getLocalDeathCountVariable(char* tDst, void* tCaller);
 void getLocalBombCountVariable(char* tDst, void* tCaller);
+int getLocalDeathCount();
+int getLocalBombCount();
 void setPlayerToFullPower();
 
 int getContinueAmount();
 void reduceContinueAmount();
 
+void savePlayerCheckpoint();
+void restorePlayerCheckpoint();
+
 void disablePlayerBossCollision();
\ No newline at end of file
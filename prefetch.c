@@ -0,0 +1,209 @@
+#include "prefetch.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+
+#include <tari/log.h>
+
+#ifdef DREAMCAST
+#include <kos/fs_ramdisk.h>
+#endif
+
+#define MAX_PREFETCH_FILE_AMOUNT 8
+
+// reads block the main loop, so keep a slice well below one frame
+#ifdef DREAMCAST
+#define PREFETCH_CHUNK_SIZE (8 * 1024)
+#else
+#define PREFETCH_CHUNK_SIZE (64 * 1024)
+#endif
+
+typedef struct {
+	char mPath[1024];
+	PrefetchDoneCB mCB;
+	void* mCaller;
+
+	FileHandler mFile;
+	uint32_t mSize;
+	uint32_t mPosition;
+	char* mData;
+
+	int mIsOpen;
+	int mIsDone;
+	int mIsAttached;
+} PrefetchFile;
+
+static struct {
+	int mAmount;
+	int mCurrent;
+	PrefetchFile mFiles[MAX_PREFETCH_FILE_AMOUNT];
+} gData;
+
+void prefetchFile(char* tPath, PrefetchDoneCB tCB, void* tCaller)
+{
+	if (gData.mAmount >= MAX_PREFETCH_FILE_AMOUNT) return;
+	if (strlen(tPath) >= sizeof(gData.mFiles[0].mPath)) return;
+	if (!isFile(tPath)) return;
+
+	int i;
+	for (i = 0; i < gData.mAmount; i++) {
+		if (!strcmp(gData.mFiles[i].mPath, tPath)) return;
+	}
+
+	PrefetchFile* e = &gData.mFiles[gData.mAmount++];
+	strcpy(e->mPath, tPath);
+	e->mCB = tCB;
+	e->mCaller = tCaller;
+	e->mSize = 0;
+	e->mPosition = 0;
+	e->mData = NULL;
+	e->mIsOpen = 0;
+	e->mIsDone = 0;
+	e->mIsAttached = 0;
+}
+
+static void closePrefetchFile(PrefetchFile* e) {
+	if (!e->mIsOpen) return;
+	fileClose(e->mFile);
+	e->mIsOpen = 0;
+}
+
+static int openPrefetchFile(PrefetchFile* e) {
+	e->mFile = fileOpen(e->mPath, O_RDONLY);
+	if (e->mFile == FILEHND_INVALID) return 0;
+
+	e->mIsOpen = 1;
+	e->mSize = fileTotal(e->mFile);
+	// outlives the screen's memory stack, so it can't come from allocMemory
+	e->mData = malloc(e->mSize + 1);
+	if (!e->mData) {
+		closePrefetchFile(e);
+		return 0;
+	}
+
+	return 1;
+}
+
+static void getAttachedPrefetchFileName(char* tDst, PrefetchFile* e) {
+	sprintf(tDst, "/prefetch%d", (int)(e - gData.mFiles));
+}
+
+// the ramdisk serves the buffer in place, so path-based loaders read it without touching the disc
+static void attachPrefetchFile(PrefetchFile* e) {
+#ifdef DREAMCAST
+	char name[100];
+	getAttachedPrefetchFileName(name, e);
+	e->mIsAttached = !fs_ramdisk_attach(name, e->mData, e->mSize);
+#else
+	(void)e;
+#endif
+}
+
+static void detachPrefetchFile(PrefetchFile* e) {
+#ifdef DREAMCAST
+	if (!e->mIsAttached) return;
+	char name[100];
+	void* data;
+	size_t size;
+	getAttachedPrefetchFileName(name, e);
+	fs_ramdisk_detach(name, &data, &size);
+#endif
+	e->mIsAttached = 0;
+}
+
+static void finishPrefetchFile(PrefetchFile* e) {
+	closePrefetchFile(e);
+	e->mIsDone = 1;
+	gData.mCurrent++;
+	attachPrefetchFile(e);
+
+	if (e->mCB) e->mCB(e->mCaller, makeBuffer(e->mData, e->mSize));
+}
+
+static void failPrefetchFile(PrefetchFile* e) {
+	logWarningFormat("Unable to prefetch %s.", e->mPath);
+	closePrefetchFile(e);
+	free(e->mData);
+	e->mData = NULL;
+	e->mCB = NULL;
+	e->mIsDone = 1;
+	gData.mCurrent++;
+}
+
+static void updateCurrentPrefetchFile() {
+	PrefetchFile* e = &gData.mFiles[gData.mCurrent];
+	if (!e->mIsOpen && !openPrefetchFile(e)) {
+		failPrefetchFile(e);
+		return;
+	}
+
+	uint32_t size = e->mSize - e->mPosition;
+	if (size > PREFETCH_CHUNK_SIZE) size = PREFETCH_CHUNK_SIZE;
+	if (size && fileRead(e->mFile, e->mData + e->mPosition, size) != size) {
+		failPrefetchFile(e);
+		return;
+	}
+
+	e->mPosition += size;
+	if (e->mPosition >= e->mSize) {
+		finishPrefetchFile(e);
+	}
+}
+
+static void updatePrefetchHandler(void* tData) {
+	(void)tData;
+	if (gData.mCurrent >= gData.mAmount) return;
+
+	updateCurrentPrefetchFile();
+}
+
+ActorBlueprint PrefetchHandler = {
+	.mUpdate = updatePrefetchHandler,
+};
+
+int adoptPrefetchedFile(char* tPath, Buffer* oBuffer)
+{
+	int i;
+	for (i = 0; i < gData.mAmount; i++) {
+		PrefetchFile* e = &gData.mFiles[i];
+		if (!e->mIsDone || !e->mData) continue;
+		if (strcmp(tPath, e->mPath)) continue;
+
+		*oBuffer = makeBuffer(e->mData, e->mSize);
+		return 1;
+	}
+
+	return 0;
+}
+
+void getPrefetchedFilePath(char* tDst, char* tPath)
+{
+	int i;
+	for (i = 0; i < gData.mAmount; i++) {
+		PrefetchFile* e = &gData.mFiles[i];
+		if (!e->mIsAttached) continue;
+		if (strcmp(tPath, e->mPath)) continue;
+
+		char name[100];
+		getAttachedPrefetchFileName(name, e);
+		sprintf(tDst, "$/ram%s", name);
+		return;
+	}
+
+	strcpy(tDst, tPath);
+}
+
+void clearPrefetchedFiles()
+{
+	int i;
+	for (i = 0; i < gData.mAmount; i++) {
+		detachPrefetchFile(&gData.mFiles[i]);
+		closePrefetchFile(&gData.mFiles[i]);
+		free(gData.mFiles[i].mData);
+	}
+
+	gData.mAmount = 0;
+	gData.mCurrent = 0;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <tari/actorhandler.h>
+#include <tari/file.h>
+
+typedef void(*PrefetchDoneCB)(void* tCaller, Buffer tBuffer);
+
+extern ActorBlueprint PrefetchHandler;
+
+void prefetchFile(char* tPath, PrefetchDoneCB tCB, void* tCaller);
+int adoptPrefetchedFile(char* tPath, Buffer* oBuffer);
+void getPrefetchedFilePath(char* tDst, char* tPath);
+void clearPrefetchedFiles();
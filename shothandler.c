@@ -1,11 +1,11 @@
 #include "shothandler.h"
 
 #include <assert.h>
+#include <stdint.h>
 
 #include <tari/mugenspritefilereader.h>
 #include <tari/mugenanimationreader.h>
 #include <tari/collisionhandler.h>
-#include <tari/physicshandler.h>
 #include <tari/mugenanimationhandler.h>
 #include <tari/log.h>
 #include <tari/system.h>
@@ -18,6 +18,10 @@
 #include "enemyhandler.h"
 #include "boss.h"
 #include "player.h"
+#include "compiledassignment.h"
+#include "bundle.h"
+#include "itemhandler.h"
+#include "assetregistry.h"
 
 typedef enum {
 	SHOT_TYPE_NORMAL,
@@ -27,33 +31,104 @@ typedef enum {
 	SHOT_TYPE_TARGET_RANDOM_FINAL,
 } ShotHomingType;
 
+typedef enum {
+	SHOT_GIMMICK_BIG_BANG,
+	SHOT_GIMMICK_BOUNCE,
+	SHOT_GIMMICK_ACKERMANN,
+	SHOT_GIMMICK_GROOVY,
+	SHOT_GIMMICK_BLAM,
+	SHOT_GIMMICK_TRANSIENCE,
+} ShotGimmickType;
+
+typedef struct SubShotPool SubShotPool;
+
+typedef struct {
+	char* mName;
+	ShotGimmickType mType;
+	void(*mLoad)(SubShotPool* tPool, int i);
+	void(*mUpdate)(SubShotPool* tPool, int i);
+} ShotGimmick;
+
+typedef struct {
+	Position mTarget;
+	int mState;
+} BigBangData;
+
+typedef struct {
+
+	Velocity mDirection;
+	double mState;
+	int mIsActive;
+} AckermannData;
+
+typedef struct {
+	Duration mNow;	
+} TransienceData;
+
+typedef union {
+	BigBangData mBigBang;
+	AckermannData mAckermann;
+	TransienceData mTransience;
+} SubShotGimmickData;
+
 typedef struct {
-	MugenAssignment* mAmount;
+	Position mAbsolutePosition;
+	Vector3D mOffset;
+	Velocity mVelocity;
+	double mRotation;
+} SubShotSpawn;
+
+typedef struct {
+	int mAmount;
+	SubShotSpawn* mSpawns;
+} SubShotSpawnTable;
+
+typedef enum {
+	SHOT_COLOR_MODE_CONSTANT,
+	SHOT_COLOR_MODE_RAINBOW,
+	SHOT_COLOR_MODE_EVALUATED,
+} ShotColorMode;
+
+struct SubShotType;
+struct SubShotAssignmentParseCaller;
+
+typedef void(*SubShotSpawnFunction)(struct SubShotAssignmentParseCaller* tCaller, struct SubShotType* tSubShot, SubShotSpawn* oSpawn);
+typedef Velocity(*SubShotDirectionFunction)(struct SubShotAssignmentParseCaller* tCaller, struct SubShotType* tSubShot, Vector3D tOffset, double* oAngle);
+
+typedef struct SubShotType {
+	CompiledAssignment* mAmount;
 
 	ShotHomingType mHomingType;
 
-	MugenAssignment* mOffset;
+	CompiledAssignment* mOffset;
 
 	int mHasAbsolutePosition;
-	MugenAssignment* mAbsolutePosition;
+	CompiledAssignment* mAbsolutePosition;
 
 	int mHasVelocity;
-	MugenAssignment* mVelocity;
+	CompiledAssignment* mVelocity;
 	int mHasAngle;
-	MugenAssignment* mAngle;
+	CompiledAssignment* mAngle;
 	int mHasSpeed;
-	MugenAssignment* mSpeed;
+	CompiledAssignment* mSpeed;
 
-	MugenAssignment* mStartRotation;
-	MugenAssignment* mRotationAdd;
+	CompiledAssignment* mStartRotation;
+	CompiledAssignment* mRotationAdd;
 
-	MugenAssignment* mGimmick;
+	ShotGimmick* mGimmick;
 
 	int mIdleAnimation;
 	int mHitAnimation;
 
 	CollisionCirc mColCirc;
+	ShotColorMode mColorMode;
+	Vector3D mColorRGB;
 	MugenAssignment* mColor;
+
+	int mIsBallistic;
+	SubShotSpawnTable* mSpawnTable;
+	SubShotSpawnFunction mSpawn;
+	SubShotDirectionFunction mEvaluateDirection;
 } SubShotType;
 
 typedef struct {
@@ -61,35 +136,103 @@ typedef struct {
 	IntMap mSubShots;
 } ShotType;
 
+#define BOSS_COLLISION_BROADPHASE_RADIUS 256
+
+#define MAX_PLAYER_SUB_SHOT_AMOUNT 1000
+#define MAX_ENEMY_SUB_SHOT_AMOUNT 2000
+#define MAX_FINAL_BOSS_SUB_SHOT_AMOUNT 500
+#define SUB_SHOT_SPAWN_BUDGET_PER_FRAME 64
+#define SUB_SHOT_RESERVATION_RECYCLE_PER_FRAME 32
+#define SHOT_CONVERSION_MAX_ITEM_AMOUNT 32
+
+typedef enum {
+	SUB_SHOT_BUCKET_PLAYER,
+	SUB_SHOT_BUCKET_ENEMY,
+	SUB_SHOT_BUCKET_FINAL_BOSS,
+	SUB_SHOT_BUCKET_AMOUNT,
+} SubShotBucket;
+
+typedef enum {
+	SUB_SHOT_FLAG_IS_STILL_ACTIVE = (1 << 0),
+	SUB_SHOT_FLAG_IS_UNLOADED = (1 << 1),
+	SUB_SHOT_FLAG_IS_IN_COLLISION_HANDLER = (1 << 2),
+	SUB_SHOT_FLAG_IS_BALLISTIC = (1 << 3),
+	SUB_SHOT_FLAG_IS_PENDING = (1 << 4),
+} SubShotFlag;
 
 typedef struct {
-	ShotType* mType;
-	IntMap mSubShots;
-	int mSubShotsLeft;
+	SubShotPool* mPool;
+	int mIndex;
+	Position mPosition;
+} SubShotSlot;
+
+struct SubShotPool {
+	int mAmount;
+	int mCapacity;
+	int mLimit;
+	int mFrame;
+
+	Position* mPositions;
+	Velocity* mVelocities;
+	double* mRotations;
+	SubShotType** mTypes;
+	int* mFlags;
+
+	int* mAnimationIDs;
+	int* mCollisionIDs;
+	Collider* mColliders;
+	CollisionData* mCollisionData;
+
+	SubShotGimmickData* mGimmickData;
+
+	Position* mSpawnPositions;
+	int* mSpawnFrames;
+	int* mEndFrames;
+
+	SubShotSlot* mSlots; // stable across swap-removes, handed out as collision callers and positions
+	int* mSlotIDs;
+	int mIsTestedAgainstPlayer;
+};
 
-	CollisionData mCollisionData;
-} ActiveShot;
+#define PLAYER_HIT_TEST_MASK_SIZE 32
 
+#define SHOT_BUDGET_AGE_BUCKET_AMOUNT 32
+#define SHOT_BUDGET_AGE_BUCKET_SIZE 16
+#define SHOT_BUDGET_OFF_CENTER_RADIUS 160
+#define SHOT_BUDGET_HIDDEN_MARGIN 16
 
 typedef struct {
-	ActiveShot* mRoot;
+	int mAmount;
+	ShotBudgetPolicy mPolicy;
+	int mThinningFactor;
+	int mReservedAmount;
 
-	SubShotType* mType;
+	ShotBudgetStatistics mStatistics;
+} ShotBudget;
 
-	int mPhysicsID;
-	int mAnimationID;
-	int mCollisionID;
+#define BOMB_FIELD_ANIMATION 4001
+#define BOMB_FIELD_GROWTH_PER_FRAME 8
+#define BOMB_FIELD_MAX_RADIUS 720
+#define BOMB_FIELD_COLOR_INTERVAL 4
 
-	Collider mCollider;
-	int mListID;
+typedef struct {
+	int mIsActive;
+	Position* mCenterReference;
+	double mRadius;
+	int mFrame;
 
-	double mRotation;
+	int mAnimationID;
+	double mSpriteRadius;
+} BombField;
 
-	int mHasGimmickData;
-	void* mGimmickData;
+typedef struct {
+	int mCapacity;
 
-	int mIsStillActive;
-} ActiveSubShot;
+	float* mX;
+	float* mY;
+	float* mRadiusSquared;
+	uint32_t* mHitMasks;
+} PlayerHitTest;
 
 static struct {
 	MugenSpriteFile mSprites;
@@ -97,20 +240,32 @@ static struct {
 
 	IntMap mShotTypes;
 
-	IntMap mActiveShots;
+	SubShotPool mPools[SUB_SHOT_BUCKET_AMOUNT];
+	PlayerHitTest mPlayerHitTest;
+	ShotBudget mBudget;
+	int mSpawnBudget;
+	BombField mBombField;
 
 	int mFinalBossShotsDeflected;
 } gData;
 
+typedef enum {
+	SHOT_BUNDLE_RECORD_END,
+	SHOT_BUNDLE_RECORD_SHOT,
+	SHOT_BUNDLE_RECORD_SUB_SHOT,
+	SHOT_BUNDLE_RECORD_BUDGET,
+} ShotBundleRecord;
+
 static ShotType* gActiveShotType;
+static BundleWriter* gShotBundleWriter;
 
 static int isShotType(MugenDefScriptGroup* tGroup) {
 	return !strcmp("Shot", tGroup->mName);
 }
 
-static void handleNewShotType(MugenDefScriptGroup* tGroup) {
+static void addShotType(int tID) {
 	ShotType* e = allocMemory(sizeof(ShotType));
-	e->mID = getMugenDefNumberVariableAsGroup(tGroup, "id");
+	e->mID = tID;
 	e->mSubShots = new_int_map();
 
 	int_map_push_owned(&gData.mShotTypes, e->mID, e);
@@ -118,6 +273,14 @@ static void handleNewShotType(MugenDefScriptGroup* tGroup) {
 	gActiveShotType = e;
 }
 
+static void handleNewShotType(MugenDefScriptGroup* tGroup) {
+	addShotType(getMugenDefNumberVariableAsGroup(tGroup, "id"));
+
+	if (!gShotBundleWriter) return;
+	writeBundleInteger(gShotBundleWriter, SHOT_BUNDLE_RECORD_SHOT);
+	writeBundleInteger(gShotBundleWriter, gActiveShotType->mID);
+}
+
 static int isSubShotType(MugenDefScriptGroup* tGroup) {
 	return !strcmp("SubShot", tGroup->mName);
 }
@@ -149,29 +312,147 @@ static void parseHomingType(SubShotType* e, MugenDefScriptGroup* tGroup) {
 	freeMemory(text);
 }
 
+static void parseGimmick(SubShotType* e, MugenDefScriptGroup* tGroup);
+static int getShotGimmickIndex(ShotGimmick* tGimmick);
+static ShotGimmick* getShotGimmickFromIndex(int tIndex);
+static void parseShotColor(SubShotType* e, MugenDefScriptGroup* tGroup);
+static void setSubShotSpawnFunctions(SubShotType* e);
+
+static void addSubShotTypeToActiveShotType(SubShotType* e) {
+	setSubShotSpawnFunctions(e);
+	int_map_push_back_owned(&gActiveShotType->mSubShots, e);
+}
+
+static void writeSubShotTypeToBundle(BundleWriter* tWriter, SubShotType* e, MugenDefScriptGroup* tGroup) {
+	writeBundleInteger(tWriter, SHOT_BUNDLE_RECORD_SUB_SHOT);
+	writeCompiledAssignmentToBundle(tWriter, e->mAmount);
+	writeBundleInteger(tWriter, e->mIdleAnimation);
+	writeBundleInteger(tWriter, e->mHitAnimation);
+	writeCompiledAssignmentToBundle(tWriter, e->mOffset);
+	writeBundleInteger(tWriter, e->mHasAbsolutePosition);
+	writeCompiledAssignmentToBundle(tWriter, e->mAbsolutePosition);
+	writeBundleInteger(tWriter, e->mHasVelocity);
+	writeCompiledAssignmentToBundle(tWriter, e->mVelocity);
+	writeBundleInteger(tWriter, e->mHasAngle);
+	writeCompiledAssignmentToBundle(tWriter, e->mAngle);
+	writeBundleInteger(tWriter, e->mHasSpeed);
+	writeCompiledAssignmentToBundle(tWriter, e->mSpeed);
+	writeCompiledAssignmentToBundle(tWriter, e->mStartRotation);
+	writeCompiledAssignmentToBundle(tWriter, e->mRotationAdd);
+
+	writeBundleInteger(tWriter, e->mColorMode);
+	writeBundleVector3D(tWriter, e->mColorRGB);
+	if (e->mColorMode == SHOT_COLOR_MODE_EVALUATED) {
+		char* text = getAllocatedMugenDefStringVariableAsGroup(tGroup, "color");
+		writeBundleString(tWriter, text);
+		freeMemory(text);
+	}
+
+	writeBundleInteger(tWriter, getShotGimmickIndex(e->mGimmick));
+	writeBundleVector3D(tWriter, e->mColCirc.mCenter);
+	writeBundleFloat(tWriter, e->mColCirc.mRadius);
+	writeBundleInteger(tWriter, e->mHomingType);
+}
+
+static void readSubShotTypeFromBundle(BundleReader* tReader) {
+	SubShotType* e = allocMemory(sizeof(SubShotType));
+	e->mAmount = readCompiledAssignmentFromBundle(tReader);
+	e->mIdleAnimation = readBundleInteger(tReader);
+	e->mHitAnimation = readBundleInteger(tReader);
+	e->mOffset = readCompiledAssignmentFromBundle(tReader);
+	e->mHasAbsolutePosition = readBundleInteger(tReader);
+	e->mAbsolutePosition = readCompiledAssignmentFromBundle(tReader);
+	e->mHasVelocity = readBundleInteger(tReader);
+	e->mVelocity = readCompiledAssignmentFromBundle(tReader);
+	e->mHasAngle = readBundleInteger(tReader);
+	e->mAngle = readCompiledAssignmentFromBundle(tReader);
+	e->mHasSpeed = readBundleInteger(tReader);
+	e->mSpeed = readCompiledAssignmentFromBundle(tReader);
+	e->mStartRotation = readCompiledAssignmentFromBundle(tReader);
+	e->mRotationAdd = readCompiledAssignmentFromBundle(tReader);
+
+	e->mColorMode = readBundleInteger(tReader);
+	e->mColorRGB = readBundleVector3D(tReader);
+	e->mColor = NULL;
+	if (e->mColorMode == SHOT_COLOR_MODE_EVALUATED) {
+		char* text = readAllocatedBundleString(tReader);
+		e->mColor = parseMugenAssignmentFromString(text);
+		freeMemory(text);
+	}
+
+	e->mGimmick = getShotGimmickFromIndex(readBundleInteger(tReader));
+	Position center = readBundleVector3D(tReader);
+	double radius = readBundleFloat(tReader);
+	e->mColCirc = makeCollisionCirc(center, radius);
+	e->mHomingType = readBundleInteger(tReader);
+
+	addSubShotTypeToActiveShotType(e);
+}
+
 static void handleNewSubShotType(MugenDefScriptGroup* tGroup) {
 	assert(gActiveShotType);
 
 	SubShotType* e = allocMemory(sizeof(SubShotType));
-	fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString("amount", tGroup, &e->mAmount, "");
+	fetchCompiledAssignmentFromGroupAndReturnWhetherItExistsDefaultString("amount", tGroup, &e->mAmount, "");
 	e->mIdleAnimation = getMugenDefNumberVariableAsGroup(tGroup, "anim");
 	e->mHitAnimation = getMugenDefNumberVariableAsGroup(tGroup, "hitanim");
-	fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString("offset", tGroup, &e->mOffset, "");
-	e->mHasAbsolutePosition = fetchMugenAssignmentFromGroupAndReturnWhetherItExists("absolute", tGroup, &e->mAbsolutePosition);
-	e->mHasVelocity = fetchMugenAssignmentFromGroupAndReturnWhetherItExists("velocity", tGroup, &e->mVelocity);
-	e->mHasAngle = fetchMugenAssignmentFromGroupAndReturnWhetherItExists("angle", tGroup, &e->mAngle);
-	e->mHasSpeed = fetchMugenAssignmentFromGroupAndReturnWhetherItExists("speed", tGroup, &e->mSpeed);
-	fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString("rotation", tGroup, &e->mStartRotation, "");
-	fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString("rotationadd", tGroup, &e->mRotationAdd, "");
-	fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString("color", tGroup, &e->mColor, "white");
-	fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString("gimmick", tGroup, &e->mGimmick, "");
+	fetchCompiledAssignmentFromGroupAndReturnWhetherItExistsDefaultString("offset", tGroup, &e->mOffset, "");
+	e->mHasAbsolutePosition = fetchCompiledAssignmentFromGroupAndReturnWhetherItExists("absolute", tGroup, &e->mAbsolutePosition);
+	e->mHasVelocity = fetchCompiledAssignmentFromGroupAndReturnWhetherItExists("velocity", tGroup, &e->mVelocity);
+	e->mHasAngle = fetchCompiledAssignmentFromGroupAndReturnWhetherItExists("angle", tGroup, &e->mAngle);
+	e->mHasSpeed = fetchCompiledAssignmentFromGroupAndReturnWhetherItExists("speed", tGroup, &e->mSpeed);
+	fetchCompiledAssignmentFromGroupAndReturnWhetherItExistsDefaultString("rotation", tGroup, &e->mStartRotation, "");
+	fetchCompiledAssignmentFromGroupAndReturnWhetherItExistsDefaultString("rotationadd", tGroup, &e->mRotationAdd, "");
+	parseShotColor(e, tGroup);
+	parseGimmick(e, tGroup);
 
 	Position center = getMugenDefVectorOrDefaultAsGroup(tGroup, "center", makePosition(0, 0, 0));
 	double radius = getMugenDefFloatVariableAsGroup(tGroup, "radius");
 	e->mColCirc = makeCollisionCirc(center, radius);
 	parseHomingType(e, tGroup);
+	if (gShotBundleWriter) writeSubShotTypeToBundle(gShotBundleWriter, e, tGroup);
 
-	int_map_push_back_owned(&gActiveShotType->mSubShots, e);
+	addSubShotTypeToActiveShotType(e);
+}
+
+static int isShotBudgetGroup(MugenDefScriptGroup* tGroup) {
+	return !strcmp("Budget", tGroup->mName);
+}
+
+static ShotBudgetPolicy parseShotBudgetPolicy(MugenDefScriptGroup* tGroup) {
+	if (!string_map_contains(&tGroup->mElements, "policy")) return SHOT_BUDGET_POLICY_REFUSE;
+
+	ShotBudgetPolicy ret = SHOT_BUDGET_POLICY_REFUSE;
+	char* text = getAllocatedMugenDefStringVariableAsGroup(tGroup, "policy");
+	if (!strcmp("refuse", text)) {
+		ret = SHOT_BUDGET_POLICY_REFUSE;
+	}
+	else if (!strcmp("recycle", text)) {
+		ret = SHOT_BUDGET_POLICY_RECYCLE;
+	}
+	else if (!strcmp("thin", text)) {
+		ret = SHOT_BUDGET_POLICY_THIN;
+	}
+	else {
+		logError("Unrecognized budget policy");
+		logErrorString(text);
+		abortSystem();
+	}
+
+	freeMemory(text);
+	return ret;
+}
+
+static void handleShotBudget(MugenDefScriptGroup* tGroup) {
+	int amount = getMugenDefIntegerOrDefaultAsGroup(tGroup, "amount", gData.mBudget.mAmount);
+	int thinningFactor = getMugenDefIntegerOrDefaultAsGroup(tGroup, "thinning", gData.mBudget.mThinningFactor);
+	setShotBudget(amount, parseShotBudgetPolicy(tGroup), thinningFactor);
+
+	if (!gShotBundleWriter) return;
+	writeBundleInteger(gShotBundleWriter, SHOT_BUNDLE_RECORD_BUDGET);
+	writeBundleInteger(gShotBundleWriter, gData.mBudget.mAmount);
+	writeBundleInteger(gShotBundleWriter, gData.mBudget.mPolicy);
+	writeBundleInteger(gShotBundleWriter, gData.mBudget.mThinningFactor);
 }
 
 static void loadShotTypesFromScript(MugenDefScript* tScript) {
@@ -180,35 +461,237 @@ static void loadShotTypesFromScript(MugenDefScript* tScript) {
 	resetMugenScriptParser();
 	addMugenScriptParseFunction(isShotType, handleNewShotType);
 	addMugenScriptParseFunction(isSubShotType, handleNewSubShotType);
+	addMugenScriptParseFunction(isShotBudgetGroup, handleShotBudget);
 	parseMugenScript(tScript);
 }
 
+static void loadShotTypesFromDefinitionFile(char* tPath, char* tBundlePath) {
+	BundleWriter writer;
+	gShotBundleWriter = NULL;
+	if (isBundleCompilationActive()) {
+		openBundleForWriting(&writer, "shots", tPath);
+		gShotBundleWriter = &writer;
+	}
+
+	MugenDefScript script = loadMugenDefScript(tPath);
+	loadShotTypesFromScript(&script);
+	unloadMugenDefScript(script);
+
+	if (!gShotBundleWriter) return;
+	writeBundleInteger(gShotBundleWriter, SHOT_BUNDLE_RECORD_END);
+	saveBundleAndClose(gShotBundleWriter, tBundlePath);
+	gShotBundleWriter = NULL;
+}
+
+static int loadShotTypesFromBundle(char* tPath, char* tBundlePath) {
+	BundleReader reader;
+	if (!openBundleForReading(&reader, tBundlePath, "shots", tPath)) return 0;
+
+	gActiveShotType = NULL;
+	int record;
+	while (!reader.mHasFailed && (record = readBundleInteger(&reader)) != SHOT_BUNDLE_RECORD_END) {
+		if (record == SHOT_BUNDLE_RECORD_SHOT) {
+			addShotType(readBundleInteger(&reader));
+		}
+		else if (record == SHOT_BUNDLE_RECORD_SUB_SHOT && gActiveShotType) {
+			readSubShotTypeFromBundle(&reader);
+		}
+		else if (record == SHOT_BUNDLE_RECORD_BUDGET) {
+			int amount = readBundleInteger(&reader);
+			ShotBudgetPolicy policy = readBundleInteger(&reader);
+			setShotBudget(amount, policy, readBundleInteger(&reader));
+		}
+		else {
+			reader.mHasFailed = 1;
+		}
+	}
+
+	if (!closeBundleAndReturnWhetherItWasValid(&reader)) {
+		logError("Corrupt shot bundle");
+		logErrorString(tBundlePath);
+		abortSystem();
+	}
+
+	return 1;
+}
+
+static void loadSubShotPool(SubShotPool* pool, int tCapacity) {
+	pool->mAmount = 0;
+	pool->mCapacity = tCapacity;
+	pool->mLimit = tCapacity;
+	pool->mFrame = 0;
+	pool->mIsTestedAgainstPlayer = 0;
+
+	pool->mPositions = allocMemory(sizeof(Position) * tCapacity);
+	pool->mVelocities = allocMemory(sizeof(Velocity) * tCapacity);
+	pool->mRotations = allocMemory(sizeof(double) * tCapacity);
+	pool->mTypes = allocMemory(sizeof(SubShotType*) * tCapacity);
+	pool->mFlags = allocMemory(sizeof(int) * tCapacity);
+	pool->mAnimationIDs = allocMemory(sizeof(int) * tCapacity);
+	pool->mCollisionIDs = allocMemory(sizeof(int) * tCapacity);
+	pool->mColliders = allocMemory(sizeof(Collider) * tCapacity);
+	pool->mCollisionData = allocMemory(sizeof(CollisionData) * tCapacity);
+	pool->mGimmickData = allocMemory(sizeof(SubShotGimmickData) * tCapacity);
+	pool->mSpawnPositions = allocMemory(sizeof(Position) * tCapacity);
+	pool->mSpawnFrames = allocMemory(sizeof(int) * tCapacity);
+	pool->mEndFrames = allocMemory(sizeof(int) * tCapacity);
+	pool->mSlots = allocMemory(sizeof(SubShotSlot) * tCapacity);
+	pool->mSlotIDs = allocMemory(sizeof(int) * tCapacity);
+
+	int i;
+	for (i = 0; i < tCapacity; i++) {
+		pool->mSlots[i].mPool = pool;
+		pool->mSlots[i].mIndex = i;
+		pool->mSlotIDs[i] = i;
+	}
+}
+
+static void loadSubShotPools() {
+	loadSubShotPool(&gData.mPools[SUB_SHOT_BUCKET_PLAYER], MAX_PLAYER_SUB_SHOT_AMOUNT);
+	loadSubShotPool(&gData.mPools[SUB_SHOT_BUCKET_ENEMY], MAX_ENEMY_SUB_SHOT_AMOUNT);
+	loadSubShotPool(&gData.mPools[SUB_SHOT_BUCKET_FINAL_BOSS], MAX_FINAL_BOSS_SUB_SHOT_AMOUNT);
+	gData.mPools[SUB_SHOT_BUCKET_ENEMY].mIsTestedAgainstPlayer = 1;
+}
+
+static void loadPlayerHitTest() {
+	PlayerHitTest* test = &gData.mPlayerHitTest;
+	int maskAmount = (MAX_ENEMY_SUB_SHOT_AMOUNT + PLAYER_HIT_TEST_MASK_SIZE - 1) / PLAYER_HIT_TEST_MASK_SIZE;
+	test->mCapacity = maskAmount * PLAYER_HIT_TEST_MASK_SIZE;
+
+	test->mX = allocMemory(sizeof(float) * test->mCapacity);
+	test->mY = allocMemory(sizeof(float) * test->mCapacity);
+	test->mRadiusSquared = allocMemory(sizeof(float) * test->mCapacity);
+	test->mHitMasks = allocMemory(sizeof(uint32_t) * maskAmount);
+}
+
+static SubShotPool* getSubShotPoolForCollisionList(int tCollisionList) {
+	if (tCollisionList == getPlayerShotCollisionList()) return &gData.mPools[SUB_SHOT_BUCKET_PLAYER];
+	else if (tCollisionList == getEnemyShotCollisionList()) return &gData.mPools[SUB_SHOT_BUCKET_ENEMY];
+	else return &gData.mPools[SUB_SHOT_BUCKET_FINAL_BOSS];
+}
+
 static void loadShotHandler(void* tData) {
 	(void)tData;
 
-	gData.mSprites = loadMugenSpriteFileWithoutPalette("assets/shots/SHOTS.sff");
-	gData.mAnimations = loadMugenAnimationFile("assets/shots/SHOTS.air");
+	gData.mSprites = acquireMugenSpriteFileWithoutPalette("assets/shots/SHOTS.sff");
+	gData.mAnimations = acquireMugenAnimationFile("assets/shots/SHOTS.air");
 
 	gData.mShotTypes = new_int_map();
-	gData.mActiveShots = new_int_map();
-
-	MugenDefScript script = loadMugenDefScript("assets/shots/SHOTS.def");
-	loadShotTypesFromScript(&script);
-	unloadMugenDefScript(script);
+	loadSubShotPools();
+	loadPlayerHitTest();
+	setShotBudget(MAX_ENEMY_SUB_SHOT_AMOUNT, SHOT_BUDGET_POLICY_REFUSE, 2);
+	resetShotBudgetStatistics();
+
+	char bundlePath[1024];
+	getBundlePathFromDefinitionPath(bundlePath, "assets/shots/SHOTS.def");
+	if (!loadShotTypesFromBundle("assets/shots/SHOTS.def", bundlePath)) {
+		loadShotTypesFromDefinitionFile("assets/shots/SHOTS.def", bundlePath);
+	}
 
+	gData.mSpawnBudget = SUB_SHOT_SPAWN_BUDGET_PER_FRAME;
+	gData.mBombField.mIsActive = 0;
 	gData.mFinalBossShotsDeflected = 0;
 }
 
-static void unloadSubShot(ActiveSubShot* e) {
-	if (e->mHasGimmickData) {
-		freeMemory(e->mGimmickData);
+static void shotHitCB(void* tCaller, void* tCollisionData);
+static void finalBossShotHitCB(void* tCaller, void* tCollisionData);
+
+static void addSubShotToCollisionHandler(SubShotPool* pool, int i) {
+	CollisionData* collisionData = &pool->mCollisionData[i];
+
+	void(*hitCB)(void*, void*);
+	if (collisionData->mCollisionList == getEnemyCollisionList()) hitCB = finalBossShotHitCB;
+	else hitCB = shotHitCB;
+
+	SubShotSlot* slot = &pool->mSlots[pool->mSlotIDs[i]];
+	slot->mPosition = pool->mPositions[i];
+	pool->mCollisionIDs[i] = addColliderToCollisionHandler(collisionData->mCollisionList, &slot->mPosition, pool->mColliders[i], hitCB, slot, collisionData);
+	pool->mFlags[i] |= SUB_SHOT_FLAG_IS_IN_COLLISION_HANDLER;
+}
+
+static void removeSubShotFromCollisionHandler(SubShotPool* pool, int i) {
+	removeFromCollisionHandler(pool->mCollisionData[i].mCollisionList, pool->mCollisionIDs[i]);
+	pool->mFlags[i] &= ~SUB_SHOT_FLAG_IS_IN_COLLISION_HANDLER;
+}
+
+static int isSubShotInCollisionBroadphaseRange(SubShotPool* pool, int i) {
+	if (pool->mIsTestedAgainstPlayer) return 0;
+
+	int collisionList = pool->mCollisionData[i].mCollisionList;
+	if (!isCollisionBroadphaseActive(collisionList)) return 1;
+
+	return isInCollisionBroadphaseRange(collisionList, pool->mPositions[i]);
+}
+
+static void updateSubShotCollisionBroadphase(SubShotPool* pool, int i) {
+	int isInRange = isSubShotInCollisionBroadphaseRange(pool, i);
+	int isInCollisionHandler = pool->mFlags[i] & SUB_SHOT_FLAG_IS_IN_COLLISION_HANDLER;
+
+	if (isInRange && !isInCollisionHandler) {
+		addSubShotToCollisionHandler(pool, i);
+	}
+	else if (!isInRange && isInCollisionHandler) {
+		removeSubShotFromCollisionHandler(pool, i);
 	}
+	else if (isInCollisionHandler) {
+		pool->mSlots[pool->mSlotIDs[i]].mPosition = pool->mPositions[i];
+	}
+}
 
-	removeMugenAnimation(e->mAnimationID);
-	removeFromCollisionHandler(e->mRoot->mCollisionData.mCollisionList, e->mCollisionID);
-	destroyCollider(&e->mCollider);
-	removeFromPhysicsHandler(e->mPhysicsID);
-	e->mRoot->mSubShotsLeft--;
+static void unloadSubShot(SubShotPool* pool, int i) {
+	if (pool->mFlags[i] & SUB_SHOT_FLAG_IS_UNLOADED) return;
+	if (pool->mFlags[i] & SUB_SHOT_FLAG_IS_PENDING) {
+		pool->mFlags[i] = SUB_SHOT_FLAG_IS_UNLOADED;
+		return;
+	}
+
+	removeMugenAnimation(pool->mAnimationIDs[i]);
+	if (pool->mFlags[i] & SUB_SHOT_FLAG_IS_IN_COLLISION_HANDLER) {
+		removeSubShotFromCollisionHandler(pool, i);
+	}
+	destroyCollider(&pool->mColliders[i]);
+	pool->mFlags[i] = SUB_SHOT_FLAG_IS_UNLOADED;
+}
+
+static void swapSubShotSlots(SubShotPool* pool, int tDst, int tSrc) {
+	int slotID = pool->mSlotIDs[tDst];
+	pool->mSlotIDs[tDst] = pool->mSlotIDs[tSrc];
+	pool->mSlotIDs[tSrc] = slotID;
+
+	pool->mSlots[pool->mSlotIDs[tDst]].mIndex = tDst;
+	pool->mSlots[pool->mSlotIDs[tSrc]].mIndex = tSrc;
+}
+
+static void moveSubShot(SubShotPool* pool, int tDst, int tSrc) {
+	swapSubShotSlots(pool, tDst, tSrc);
+
+	pool->mPositions[tDst] = pool->mPositions[tSrc];
+	pool->mVelocities[tDst] = pool->mVelocities[tSrc];
+	pool->mRotations[tDst] = pool->mRotations[tSrc];
+	pool->mTypes[tDst] = pool->mTypes[tSrc];
+	pool->mFlags[tDst] = pool->mFlags[tSrc];
+	pool->mAnimationIDs[tDst] = pool->mAnimationIDs[tSrc];
+	pool->mColliders[tDst] = pool->mColliders[tSrc];
+	pool->mCollisionData[tDst] = pool->mCollisionData[tSrc];
+	pool->mCollisionIDs[tDst] = pool->mCollisionIDs[tSrc];
+	pool->mGimmickData[tDst] = pool->mGimmickData[tSrc];
+	pool->mSpawnPositions[tDst] = pool->mSpawnPositions[tSrc];
+	pool->mSpawnFrames[tDst] = pool->mSpawnFrames[tSrc];
+	pool->mEndFrames[tDst] = pool->mEndFrames[tSrc];
+
+	if (pool->mFlags[tDst] & (SUB_SHOT_FLAG_IS_UNLOADED | SUB_SHOT_FLAG_IS_PENDING)) return;
+
+	setMugenAnimationBasePosition(pool->mAnimationIDs[tDst], &pool->mPositions[tDst]);
+}
+
+static void removeSubShot(SubShotPool* pool, int i) {
+	unloadSubShot(pool, i);
+
+	int last = pool->mAmount - 1;
+	if (i != last) {
+		moveSubShot(pool, i, last);
+	}
+	pool->mAmount--;
 }
 
 static Position getClosestEnemyPositionIncludingBoss(Position p) {
@@ -225,101 +708,223 @@ static Position getClosestEnemyPositionIncludingBoss(Position p) {
 	}
 }
 
-static void updateHoming(ActiveSubShot* e) {
-	if (e->mType->mHomingType != SHOT_TYPE_HOMING) return;
-	Position p = *getHandledPhysicsPositionReference(e->mPhysicsID);
-	Position closestEnemy = getClosestEnemyPositionIncludingBoss(p);
+static void updateHomingTowardsTarget(SubShotPool* pool, int i, Position tTarget) {
+	Position p = pool->mPositions[i];
 
-	Velocity* vel = getHandledPhysicsVelocityReference(e->mPhysicsID);
-	Vector3D dir = vecScale(vecNormalize(vecSub(closestEnemy, p)), vecLength(*vel));
+	Velocity* vel = &pool->mVelocities[i];
+	Vector3D dir = vecScale(vecNormalize(vecSub(tTarget, p)), vecLength(*vel));
 	dir.z = 0;
 	if (vecLength(dir) < 1e-6) return;
 
 	double angle = getAngleFromDirection(dir);
-	setMugenAnimationDrawAngle(e->mAnimationID, angle);
+	setMugenAnimationDrawAngle(pool->mAnimationIDs[i], angle);
 	*vel = dir;
 }
 
-static void updateFinalHoming(ActiveSubShot* e) {
-	if (e->mType->mHomingType != SHOT_TYPE_HOMING_FINAL) return;
-	Position p = *getHandledPhysicsPositionReference(e->mPhysicsID);
-	Position closestEnemy = getPlayerPosition();
+static void updateHoming(SubShotPool* pool, int i) {
+	if (pool->mTypes[i]->mHomingType != SHOT_TYPE_HOMING) return;
 
-	Velocity* vel = getHandledPhysicsVelocityReference(e->mPhysicsID);
-	Vector3D dir = vecScale(vecNormalize(vecSub(closestEnemy, p)), vecLength(*vel));
-	dir.z = 0;
-	if (vecLength(dir) < 1e-6) return;
+	Position closestEnemy = getClosestEnemyPositionIncludingBoss(pool->mPositions[i]);
+	updateHomingTowardsTarget(pool, i, closestEnemy);
+}
 
-	double angle = getAngleFromDirection(dir);
-	setMugenAnimationDrawAngle(e->mAnimationID, angle);
-	*vel = dir;
+static void updateFinalHoming(SubShotPool* pool, int i) {
+	if (pool->mTypes[i]->mHomingType != SHOT_TYPE_HOMING_FINAL) return;
+
+	updateHomingTowardsTarget(pool, i, getPlayerPosition());
+}
+
+static void updateRotation(SubShotPool* pool, int i) {
+	SubShotType* subShot = pool->mTypes[i];
+
+	double rotationAdd = getCompiledAssignmentAsFloatValueOrDefaultWhenEmpty(subShot->mRotationAdd, NULL, 0);
+	pool->mRotations[i] += rotationAdd;
+	setMugenAnimationDrawAngle(pool->mAnimationIDs[i], pool->mRotations[i]);
+}
+
+static void updateGimmick(SubShotPool* pool, int i) {
+	ShotGimmick* gimmick = pool->mTypes[i]->mGimmick;
+	if (!gimmick) return;
+
+	gimmick->mUpdate(pool, i);
+}
+
+static void updateSubShotPosition(SubShotPool* pool, int i) {
+	pool->mPositions[i] = vecAdd(pool->mPositions[i], pool->mVelocities[i]);
+}
+
+static int isSubShotOver(SubShotPool* pool, int i) {
+	if (!(pool->mFlags[i] & SUB_SHOT_FLAG_IS_STILL_ACTIVE)) return 1;
+	if (pool->mFlags[i] & SUB_SHOT_FLAG_IS_BALLISTIC) return pool->mFrame >= pool->mEndFrames[i];
+
+	Position p = pool->mPositions[i];
+	return p.x < -100 || p.x > 740 || p.y < -100 || p.y > 480;
+}
+
+static void updateSubShot(SubShotPool* pool, int i) {
+	updateRotation(pool, i);
+	updateHoming(pool, i);
+	updateFinalHoming(pool, i);
+	updateGimmick(pool, i);
+	updateSubShotPosition(pool, i);
+	updateSubShotCollisionBroadphase(pool, i);
+}
+
+static void updateBallisticSubShot(SubShotPool* pool, int i) {
+	int age = pool->mFrame - pool->mSpawnFrames[i];
+	pool->mPositions[i] = vecAdd(pool->mSpawnPositions[i], vecScale(pool->mVelocities[i], age));
+	updateSubShotCollisionBroadphase(pool, i);
 }
 
-static void updateRotation(ActiveSubShot* e) {
+static void loadSubShotDisplay(SubShotPool* pool, int i, struct SubShotAssignmentParseCaller* tAssignmentCaller);
 
-	SubShotType* subShot = e->mType;
+static void updatePendingSubShot(SubShotPool* pool, int i) {
+	int age = pool->mFrame - pool->mSpawnFrames[i];
+	pool->mPositions[i] = vecAdd(pool->mSpawnPositions[i], vecScale(pool->mVelocities[i], age));
+	if (!gData.mSpawnBudget) return;
 
-	double rotationAdd = getMugenAssignmentAsFloatValueOrDefaultWhenEmpty(subShot->mRotationAdd, NULL, 0);
-	e->mRotation += rotationAdd;
-	setMugenAnimationDrawAngle(e->mAnimationID, e->mRotation);
+	gData.mSpawnBudget--;
+	pool->mFlags[i] &= ~SUB_SHOT_FLAG_IS_PENDING;
+	loadSubShotDisplay(pool, i, NULL);
 }
 
-static void updateGimmick(ActiveSubShot* e) {
-	getMugenAssignmentAsIntegerValueOrDefaultWhenEmpty(e->mType->mGimmick, e, 0);
+static void updateSubShotPool(SubShotPool* pool) {
+	pool->mFrame++;
+
+	int i = 0;
+	while (i < pool->mAmount) {
+		if (pool->mFlags[i] & SUB_SHOT_FLAG_IS_PENDING) {
+			updatePendingSubShot(pool, i);
+		}
+		else if (pool->mFlags[i] & SUB_SHOT_FLAG_IS_BALLISTIC) {
+			updateBallisticSubShot(pool, i);
+		}
+		else if (!(pool->mFlags[i] & SUB_SHOT_FLAG_IS_UNLOADED)) {
+			updateSubShot(pool, i);
+		}
+
+		if (isSubShotOver(pool, i)) {
+			removeSubShot(pool, i);
+		}
+		else {
+			i++;
+		}
+	}
 }
 
-static int updateSubShot(void* tCaller, void* tData) {
-	(void)tCaller;
-	ActiveSubShot* e = tData;
+static void addFinalBossShotCollisionBroadphaseTargets() {
+	SubShotPool* pool = &gData.mPools[SUB_SHOT_BUCKET_FINAL_BOSS];
+	int i;
+	for (i = 0; i < pool->mAmount; i++) {
+		if (pool->mFlags[i] & (SUB_SHOT_FLAG_IS_UNLOADED | SUB_SHOT_FLAG_IS_PENDING)) continue;
+		addCollisionBroadphaseTarget(getEnemyCollisionList(), pool->mPositions[i], pool->mTypes[i]->mColCirc.mRadius);
+	}
+}
+
+static void updateCollisionBroadphaseTargets() {
+	resetCollisionBroadphase();
+	addEnemyCollisionBroadphaseTargets();
+	if (isBossActive()) {
+		addCollisionBroadphaseTarget(getEnemyCollisionList(), getBossPosition(), BOSS_COLLISION_BROADPHASE_RADIUS);
+	}
+	addFinalBossShotCollisionBroadphaseTargets();
+}
 
-	updateRotation(e);
-	updateHoming(e);
-	updateFinalHoming(e);
-	updateGimmick(e);
+static void packEnemyShotsForPlayerHitTest(SubShotPool* pool, double tPlayerRadius) {
+	PlayerHitTest* test = &gData.mPlayerHitTest;
 
-	Position p = *getHandledPhysicsPositionReference(e->mPhysicsID);
-	if (!e->mIsStillActive || p.x < -100 || p.x > 740 || p.y < -100 || p.y > 480) {
-		unloadSubShot(e);
-		return 1;
+	int i;
+	for (i = 0; i < pool->mAmount; i++) {
+		CollisionCirc* circ = &pool->mTypes[i]->mColCirc;
+		double radius = circ->mRadius + tPlayerRadius;
+		test->mX[i] = (float)(pool->mPositions[i].x + circ->mCenter.x);
+		test->mY[i] = (float)(pool->mPositions[i].y + circ->mCenter.y);
+		// pending shots only lack their animation, their back-dated positions are already current
+		test->mRadiusSquared[i] = (pool->mFlags[i] & SUB_SHOT_FLAG_IS_UNLOADED) ? -1.0f : (float)(radius * radius);
+		assert(!(pool->mFlags[i] & SUB_SHOT_FLAG_IS_PENDING) || test->mRadiusSquared[i] >= 0);
 	}
 
-	return 0;
+	int paddedAmount = ((pool->mAmount + PLAYER_HIT_TEST_MASK_SIZE - 1) / PLAYER_HIT_TEST_MASK_SIZE) * PLAYER_HIT_TEST_MASK_SIZE;
+	for (; i < paddedAmount; i++) {
+		test->mX[i] = test->mY[i] = 0;
+		test->mRadiusSquared[i] = -1.0f;
+	}
 }
 
-static int unloadSubShotCB(void* tCaller, void* tData) {
-	(void)tCaller;
-	ActiveSubShot* e = tData;
-	unloadSubShot(e);
-	return 1;
+static uint32_t testPlayerHitMask(float tX, float tY, const float* x, const float* y, const float* r) {
+	uint32_t mask = 0;
+	int j;
+	for (j = 0; j < PLAYER_HIT_TEST_MASK_SIZE; j += 4) {
+		float dx0 = x[j + 0] - tX, dy0 = y[j + 0] - tY;
+		float dx1 = x[j + 1] - tX, dy1 = y[j + 1] - tY;
+		float dx2 = x[j + 2] - tX, dy2 = y[j + 2] - tY;
+		float dx3 = x[j + 3] - tX, dy3 = y[j + 3] - tY;
+
+		mask |= (uint32_t)(dx0*dx0 + dy0*dy0 < r[j + 0]) << (j + 0);
+		mask |= (uint32_t)(dx1*dx1 + dy1*dy1 < r[j + 1]) << (j + 1);
+		mask |= (uint32_t)(dx2*dx2 + dy2*dy2 < r[j + 2]) << (j + 2);
+		mask |= (uint32_t)(dx3*dx3 + dy3*dy3 < r[j + 3]) << (j + 3);
+	}
+
+	return mask;
 }
 
-static void unloadShot(ActiveShot* e) {
-	int_map_remove_predicate(&e->mSubShots, unloadSubShotCB, NULL);
-	delete_int_map(&e->mSubShots);
+static void handleEnemyShotHitsOnPlayer(SubShotPool* pool, uint32_t tMask, int tBase) {
+	while (tMask) {
+		int j = 0;
+		while (!(tMask & (1u << j))) j++;
+		tMask &= ~(1u << j);
+
+		hitPlayerWithEnemyShot();
+		unloadSubShot(pool, tBase + j);
+	}
 }
 
-static int updateShot(void* tCaller, void* tData) {
-	(void)tCaller;
-	ActiveShot* e = tData;
+static void testEnemyShotsAgainstPlayer() {
+	SubShotPool* pool = &gData.mPools[SUB_SHOT_BUCKET_ENEMY];
+	PlayerHitTest* test = &gData.mPlayerHitTest;
+	if (!pool->mAmount) return;
 
-	int_map_remove_predicate(&e->mSubShots, updateSubShot, e);
+	packEnemyShotsForPlayerHitTest(pool, getPlayerHitboxRadius());
 
-	if (!e->mSubShotsLeft) {
-		unloadShot(e);
-		return 1;
+	Position p = getPlayerPosition();
+	float px = (float)p.x;
+	float py = (float)p.y;
+	int maskAmount = (pool->mAmount + PLAYER_HIT_TEST_MASK_SIZE - 1) / PLAYER_HIT_TEST_MASK_SIZE;
+	int i;
+	for (i = 0; i < maskAmount; i++) {
+		int base = i * PLAYER_HIT_TEST_MASK_SIZE;
+		test->mHitMasks[i] = testPlayerHitMask(px, py, &test->mX[base], &test->mY[base], &test->mRadiusSquared[base]);
 	}
 
-	return 0;
+	for (i = 0; i < maskAmount; i++) {
+		if (!test->mHitMasks[i]) continue;
+		handleEnemyShotHitsOnPlayer(pool, test->mHitMasks[i], i * PLAYER_HIT_TEST_MASK_SIZE);
+	}
 }
 
+static void updateSubShotReservation();
+
 static void updateActiveShots() {
-	int_map_remove_predicate(&gData.mActiveShots, updateShot, NULL);
+	updateCollisionBroadphaseTargets();
+
+	int i;
+	for (i = 0; i < SUB_SHOT_BUCKET_AMOUNT; i++) {
+		updateSubShotPool(&gData.mPools[i]);
+	}
+
+	testEnemyShotsAgainstPlayer();
+	updateSubShotReservation();
+	gData.mSpawnBudget = SUB_SHOT_SPAWN_BUDGET_PER_FRAME;
 }
 
+static void updateBombField();
+
 static void updateShotHandler(void* tData) {
 	(void)tData;
 	if (isWrapperPaused()) return;
 	updateActiveShots();
+	updateBombField();
 }
 
 ActorBlueprint ShotHandler = {
@@ -329,17 +934,26 @@ ActorBlueprint ShotHandler = {
 
 
 
-static void shotHitCB(void* tCaller, void* tCollisionData) {
+static void resolveShotHit(void* tCaller, void* tCollisionData) {
 	(void)tCollisionData;
-	ActiveSubShot* e = tCaller;
-	unloadSubShot(e); 
-	int_map_remove(&e->mRoot->mSubShots, e->mListID);
+	SubShotSlot* slot = tCaller;
+	unloadSubShot(slot->mPool, slot->mIndex);
 }
 
-static void finalBossShotHitCB(void* tCaller, void* tCollisionData) {
+static void resolveFinalBossShotHit(void* tCaller, void* tCollisionData) {
+	SubShotSlot* slot = tCaller;
+	if (slot->mPool->mFlags[slot->mIndex] & SUB_SHOT_FLAG_IS_UNLOADED) return;
 	gData.mFinalBossShotsDeflected++;
-	
-	shotHitCB(tCaller, tCollisionData);
+
+	resolveShotHit(tCaller, tCollisionData);
+}
+
+static void shotHitCB(void* tCaller, void* tCollisionData) {
+	addCollisionEvent(resolveShotHit, tCaller, tCollisionData);
+}
+
+static void finalBossShotHitCB(void* tCaller, void* tCollisionData) {
+	addCollisionEvent(resolveFinalBossShotHit, tCaller, tCollisionData);
 }
 
 static Position getRandomEnemyOrBossPosition() {
@@ -360,7 +974,7 @@ static Position getRandomEnemyOrBossPosition() {
 }
 
 typedef struct {
-	ActiveShot* mRoot;
+	int mCollisionList;
 	Position mPosition;
 } SubShotCaller;
 
@@ -370,20 +984,23 @@ static void swap(double* a, double* b) {
 	*b = c;
 }
 
-typedef struct {
-	ActiveSubShot* mActiveShot;
+typedef struct SubShotAssignmentParseCaller {
 	SubShotCaller* mActiveCaller;
 	Position* mOffsetReference; // TODO: better
 	int i;
 } SubShotAssignmentParseCaller;
 
-void getCurrentSubShotIndex(char* tOutput, void* tCaller) {
+double getCurrentSubShotIndexValue(void* tCaller) {
 	SubShotAssignmentParseCaller* caller = tCaller;
 
-	sprintf(tOutput, "%d", caller->i);
+	return caller->i;
 }
 
-void getShotAngleTowardsPlayer(char* tOutput, void* tCaller) {
+void getCurrentSubShotIndex(char* tOutput, void* tCaller) {
+	sprintf(tOutput, "%d", (int)getCurrentSubShotIndexValue(tCaller));
+}
+
+double getShotAngleTowardsPlayerValue(void* tCaller) {
 	SubShotAssignmentParseCaller* caller = tCaller;
 
 	Position pos = vecAdd(caller->mActiveCaller->mPosition, *caller->mOffsetReference);
@@ -391,190 +1008,493 @@ void getShotAngleTowardsPlayer(char* tOutput, void* tCaller) {
 
 	Vector3D direction = vecNormalize(vecSub(playerPos, pos));
 	direction.x *= -1; // TODO
-	double angle = getAngleFromDirection(direction);
-
-	sprintf(tOutput, "%f", angle);
+	return getAngleFromDirection(direction);
 }
 
-static void setShotColor(SubShotType* subShot, ActiveSubShot* e, SubShotAssignmentParseCaller* caller) {
-	double r, g, b;
+void getShotAngleTowardsPlayer(char* tOutput, void* tCaller) {
+	sprintf(tOutput, "%f", getShotAngleTowardsPlayerValue(tCaller));
+}
 
-	char* text = evaluateMugenAssignmentAndReturnAsAllocatedString(subShot->mColor, caller);
+static int getShotColorFromName(char* tName, ShotColorMode* oMode, Vector3D* oRGB) {
+	*oMode = SHOT_COLOR_MODE_CONSTANT;
 
-	if (!strcmp("white", text)) {
-		r = g = b = 1;
+	if (!strcmp("white", tName)) {
+		*oRGB = makePosition(1, 1, 1);
 	}
-	else if (!strcmp("red", text)) {
-		r = 1;
-		b = g = 0;
+	else if (!strcmp("red", tName)) {
+		*oRGB = makePosition(1, 0, 0);
 	}
-	else if (!strcmp("grey", text)) {
-		r = g = b = 0.5;
+	else if (!strcmp("grey", tName)) {
+		*oRGB = makePosition(0.5, 0.5, 0.5);
 	}
-	else if (!strcmp("yellow", text)) {
-		r = g = 1;
-		b = 0;
+	else if (!strcmp("yellow", tName)) {
+		*oRGB = makePosition(1, 1, 0);
 	}
-	else if (!strcmp("rainbow", text)) {
-		r = randfromInteger(0, 1);
-		g = randfromInteger(0, 1);
-		b = randfromInteger(0, 1);
-		if (!r && !g && !b) r = 1;
+	else if (!strcmp("rainbow", tName)) {
+		*oMode = SHOT_COLOR_MODE_RAINBOW;
 	}
-	else if (!strcmp("green", text)) {
-		r = 0;
-		g = 1;
-		b = 0;
+	else if (!strcmp("green", tName)) {
+		*oRGB = makePosition(0, 1, 0);
 	}
 	else {
-		r = g = b = 1;
+		return 0;
+	}
+
+	return 1;
+}
+
+static void extractShotColorName(char* tDst, char* tText) {
+	char* prefix = "identity(";
+	int prefixLength = strlen(prefix);
+
+	int length = 0;
+	for (; *tText; tText++) {
+		if (*tText == ' ' || *tText == '\t' || *tText == '"') continue;
+		tDst[length++] = *tText;
+	}
+	tDst[length] = '\0';
+
+	if (!strncmp(prefix, tDst, prefixLength) && length > prefixLength && tDst[length - 1] == ')') {
+		memmove(tDst, tDst + prefixLength, length - prefixLength - 1);
+		tDst[length - prefixLength - 1] = '\0';
+	}
+}
+
+static void parseShotColor(SubShotType* e, MugenDefScriptGroup* tGroup) {
+	e->mColor = NULL;
+	if (!string_map_contains(&tGroup->mElements, "color")) {
+		getShotColorFromName("white", &e->mColorMode, &e->mColorRGB);
+		return;
+	}
+
+	char* text = getAllocatedMugenDefStringVariableAsGroup(tGroup, "color");
+	char* name = allocMemory(strlen(text) + 1);
+	extractShotColorName(name, text);
+	int isResolved = getShotColorFromName(name, &e->mColorMode, &e->mColorRGB);
+	freeMemory(name);
+	freeMemory(text);
+	if (isResolved) return;
+
+	e->mColorMode = SHOT_COLOR_MODE_EVALUATED;
+	fetchMugenAssignmentFromGroupAndReturnWhetherItExistsDefaultString("color", tGroup, &e->mColor, "white");
+}
+
+static void setRainbowShotColor(int tAnimationID) {
+	double r = randfromInteger(0, 1);
+	double g = randfromInteger(0, 1);
+	double b = randfromInteger(0, 1);
+	if (!r && !g && !b) r = 1;
+
+	setMugenAnimationColor(tAnimationID, r, g, b);
+}
+
+static void setEvaluatedShotColor(SubShotType* subShot, int tAnimationID, SubShotAssignmentParseCaller* caller) {
+	ShotColorMode mode;
+	Vector3D rgb;
+
+	char* text = evaluateMugenAssignmentAndReturnAsAllocatedString(subShot->mColor, caller);
+	if (!getShotColorFromName(text, &mode, &rgb)) {
 		logError("Unrecognized color.");
 		logErrorString(text);
 		abortSystem();
 	}
+	freeMemory(text);
+
+	if (mode == SHOT_COLOR_MODE_RAINBOW) {
+		setRainbowShotColor(tAnimationID);
+	}
+	else {
+		setMugenAnimationColor(tAnimationID, rgb.x, rgb.y, rgb.z);
+	}
+}
 
-	setMugenAnimationColor(e->mAnimationID, r, g, b);
+static void setShotColor(SubShotType* subShot, int tAnimationID, SubShotAssignmentParseCaller* caller) {
+	switch (subShot->mColorMode) {
+	case SHOT_COLOR_MODE_CONSTANT:
+		setMugenAnimationColor(tAnimationID, subShot->mColorRGB.x, subShot->mColorRGB.y, subShot->mColorRGB.z);
+		break;
+	case SHOT_COLOR_MODE_RAINBOW:
+		setRainbowShotColor(tAnimationID);
+		break;
+	default:
+		setEvaluatedShotColor(subShot, tAnimationID, caller);
+		break;
+	}
+}
+
+static Velocity evaluateNoSubShotDirection(SubShotAssignmentParseCaller* assignmentCaller, SubShotType* subShot, Vector3D tOffset, double* oAngle) {
+	(void)assignmentCaller;
+	(void)subShot;
+	(void)tOffset;
+	*oAngle = 0;
+	return makePosition(0, 0, 0);
+}
+
+static Velocity evaluateSubShotVelocityDirection(SubShotAssignmentParseCaller* assignmentCaller, SubShotType* subShot, Vector3D tOffset, double* oAngle) {
+	(void)tOffset;
+	Velocity velocity = getCompiledAssignmentAsVector3DValueOrDefaultWhenEmpty(subShot->mVelocity, assignmentCaller, makePosition(0, 0, 0));
+	*oAngle = getAngleFromDirection(velocity);
+	return velocity;
+}
+
+static Velocity evaluateSubShotAngleDirection(SubShotAssignmentParseCaller* assignmentCaller, SubShotType* subShot, Vector3D tOffset, double* oAngle) {
+	(void)tOffset;
+	double angle = evaluateCompiledAssignmentAndReturnAsFloat(subShot->mAngle, assignmentCaller);
+	*oAngle = -angle; // TODO: fix
+	return getDirectionFromAngleZ(angle);
+}
+
+static Velocity evaluateSubShotTargetDirection(SubShotAssignmentParseCaller* assignmentCaller, Vector3D tOffset, Position tTarget, double* oAngle) {
+	Position p = vecAdd(assignmentCaller->mActiveCaller->mPosition, tOffset);
+	swap(&tTarget.x, &p.x);
+	double angle = getAngleFromDirection(vecSub(tTarget, p));
+	*oAngle = -angle; // TODO: fix
+	return getDirectionFromAngleZ(angle);
+}
+
+static Velocity evaluateSubShotRandomEnemyDirection(SubShotAssignmentParseCaller* assignmentCaller, SubShotType* subShot, Vector3D tOffset, double* oAngle) {
+	(void)subShot;
+	return evaluateSubShotTargetDirection(assignmentCaller, tOffset, getRandomEnemyOrBossPosition(), oAngle);
+}
+
+static Velocity evaluateSubShotPlayerDirection(SubShotAssignmentParseCaller* assignmentCaller, SubShotType* subShot, Vector3D tOffset, double* oAngle) {
+	(void)subShot;
+	return evaluateSubShotTargetDirection(assignmentCaller, tOffset, getPlayerPosition(), oAngle);
+}
+
+static SubShotDirectionFunction getSubShotDirectionFunction(SubShotType* e) {
+	if (e->mHomingType == SHOT_TYPE_TARGET_RANDOM) return evaluateSubShotRandomEnemyDirection;
+	else if (e->mHomingType == SHOT_TYPE_TARGET_RANDOM_FINAL) return evaluateSubShotPlayerDirection;
+	else if (e->mHasAngle) return evaluateSubShotAngleDirection;
+	else if (e->mHasVelocity) return evaluateSubShotVelocityDirection;
+	else return evaluateNoSubShotDirection;
+}
+
+static void evaluateSubShotSpawn(SubShotAssignmentParseCaller* assignmentCaller, SubShotType* subShot, SubShotSpawn* spawn) {
+	spawn->mOffset = getCompiledAssignmentAsVector3DValueOrDefaultWhenEmpty(subShot->mOffset, assignmentCaller, makePosition(0, 0, 0));
+	assignmentCaller->mOffsetReference = &spawn->mOffset; // TODO: better
+
+	if (subShot->mHasAbsolutePosition) {
+		spawn->mAbsolutePosition = getCompiledAssignmentAsVector3DValueOrDefaultWhenEmpty(subShot->mAbsolutePosition, assignmentCaller, makePosition(0, 0, 0));
+		assignmentCaller->mActiveCaller->mPosition = spawn->mAbsolutePosition;
+	}
+
+	double angle;
+	Velocity velocity = subShot->mEvaluateDirection(assignmentCaller, subShot, spawn->mOffset, &angle);
+	if (subShot->mHasSpeed) {
+		double speed = evaluateCompiledAssignmentAndReturnAsFloat(subShot->mSpeed, assignmentCaller);
+		velocity = vecScale(vecNormalize(velocity), speed);
+	}
+
+	spawn->mVelocity = velocity;
+	spawn->mRotation = getCompiledAssignmentAsFloatValueOrDefaultWhenEmpty(subShot->mStartRotation, assignmentCaller, angle);
+}
+
+static void copySubShotSpawnFromTable(SubShotAssignmentParseCaller* assignmentCaller, SubShotType* subShot, SubShotSpawn* spawn) {
+	if (assignmentCaller->i >= subShot->mSpawnTable->mAmount) {
+		evaluateSubShotSpawn(assignmentCaller, subShot, spawn);
+		return;
+	}
+
+	*spawn = subShot->mSpawnTable->mSpawns[assignmentCaller->i];
+	assignmentCaller->mOffsetReference = &spawn->mOffset;
+}
+
+static void copySubShotSpawnFromTableWithAbsolutePosition(SubShotAssignmentParseCaller* assignmentCaller, SubShotType* subShot, SubShotSpawn* spawn) {
+	copySubShotSpawnFromTable(assignmentCaller, subShot, spawn);
+	assignmentCaller->mActiveCaller->mPosition = spawn->mAbsolutePosition;
+}
+
+static int isSubShotAssignmentOnlyDependentOnIndex(CompiledAssignment* tAssignment) {
+	if (tAssignment->mIsEmpty) return 1;
+	return !(tAssignment->mDependencies & ~COMPILED_ASSIGNMENT_DEPENDENCY_INDEX);
+}
+
+static int canSubShotSpawnBeBaked(SubShotType* e) {
+	if (!e->mAmount->mIsEmpty && !e->mAmount->mIsConstant) return 0;
+	if (e->mHomingType == SHOT_TYPE_TARGET_RANDOM || e->mHomingType == SHOT_TYPE_TARGET_RANDOM_FINAL) return 0;
+
+	return isSubShotAssignmentOnlyDependentOnIndex(e->mOffset)
+		&& isSubShotAssignmentOnlyDependentOnIndex(e->mAbsolutePosition)
+		&& isSubShotAssignmentOnlyDependentOnIndex(e->mVelocity)
+		&& isSubShotAssignmentOnlyDependentOnIndex(e->mAngle)
+		&& isSubShotAssignmentOnlyDependentOnIndex(e->mSpeed)
+		&& isSubShotAssignmentOnlyDependentOnIndex(e->mStartRotation);
+}
+
+static void bakeSubShotSpawnTable(SubShotType* e) {
+	e->mSpawnTable = NULL;
+	if (!canSubShotSpawnBeBaked(e)) return;
+
+	SubShotSpawnTable* table = allocMemory(sizeof(SubShotSpawnTable));
+	table->mAmount = getCompiledAssignmentAsIntegerValueOrDefaultWhenEmpty(e->mAmount, NULL, 1);
+	table->mSpawns = allocMemory(sizeof(SubShotSpawn) * max(1, table->mAmount));
+
+	SubShotCaller caller;
+	caller.mCollisionList = -1;
+	caller.mPosition = makePosition(0, 0, 0);
+
+	SubShotAssignmentParseCaller assignmentCaller;
+	assignmentCaller.mActiveCaller = &caller;
+
+	int i;
+	for (i = 0; i < table->mAmount; i++) {
+		assignmentCaller.i = i;
+		evaluateSubShotSpawn(&assignmentCaller, e, &table->mSpawns[i]);
+	}
+
+	e->mSpawnTable = table;
+}
+
+static void setSubShotSpawnFunctions(SubShotType* e) {
+	e->mIsBallistic = !e->mGimmick && e->mRotationAdd->mIsEmpty && e->mHomingType != SHOT_TYPE_HOMING && e->mHomingType != SHOT_TYPE_HOMING_FINAL;
+	e->mEvaluateDirection = getSubShotDirectionFunction(e);
+	e->mSpawn = evaluateSubShotSpawn;
+
+	bakeSubShotSpawnTable(e);
+	if (!e->mSpawnTable) return;
+
+	if (e->mHasAbsolutePosition) e->mSpawn = copySubShotSpawnFromTableWithAbsolutePosition;
+	else e->mSpawn = copySubShotSpawnFromTable;
+}
+
+static int getBallisticSubShotLifetimeOnAxis(double tPosition, double tVelocity, double tMin, double tMax) {
+	if (tPosition < tMin || tPosition > tMax) return 1;
+
+	double frames;
+	if (tVelocity > 0) frames = (tMax - tPosition) / tVelocity;
+	else if (tVelocity < 0) frames = (tPosition - tMin) / -tVelocity;
+	else return INF;
+
+	return (int)max(1, min(INF, floor(frames) + 1));
+}
+
+static void setBallisticSubShotLifetime(SubShotPool* pool, int i) {
+	Position p = pool->mPositions[i];
+	Velocity v = pool->mVelocities[i];
+	int lifetimeX = getBallisticSubShotLifetimeOnAxis(p.x, v.x, -100, 740);
+	int lifetimeY = getBallisticSubShotLifetimeOnAxis(p.y, v.y, -100, 480);
+
+	pool->mSpawnPositions[i] = p;
+	pool->mEndFrames[i] = pool->mFrame + min(lifetimeX, lifetimeY);
+}
+
+static void loadSubShotDisplay(SubShotPool* pool, int i, SubShotAssignmentParseCaller* tAssignmentCaller) {
+	SubShotType* subShot = pool->mTypes[i];
+
+	pool->mColliders[i] = makeColliderFromCirc(subShot->mColCirc);
+	if (isSubShotInCollisionBroadphaseRange(pool, i)) {
+		addSubShotToCollisionHandler(pool, i);
+	}
+
+	double z;
+	if(pool->mCollisionData[i].mCollisionList == getEnemyShotCollisionList()) z = 30;
+	else z = 25;
+	pool->mAnimationIDs[i] = addMugenAnimation(getMugenAnimation(&gData.mAnimations, subShot->mIdleAnimation), &gData.mSprites, makePosition(0, 0, z));
+	setMugenAnimationBasePosition(pool->mAnimationIDs[i], &pool->mPositions[i]);
+	setMugenAnimationDrawAngle(pool->mAnimationIDs[i], pool->mRotations[i]);
+
+	setShotColor(subShot, pool->mAnimationIDs[i], tAssignmentCaller);
+}
+
+static int canSubShotDisplayBeDeferred(SubShotType* subShot) {
+	// the position of a ballistic shot only depends on its age, so a late display can be back-dated exactly
+	return subShot->mIsBallistic && subShot->mColorMode != SHOT_COLOR_MODE_EVALUATED;
 }
 
 static void addSingleSubShot(SubShotCaller* caller, SubShotType* subShot, int i) {
-	ActiveSubShot* e = allocMemory(sizeof(ActiveSubShot));
-	e->mType = subShot;
-	e->mRoot = caller->mRoot;
+	SubShotPool* pool = getSubShotPoolForCollisionList(caller->mCollisionList);
+	if (pool->mAmount >= pool->mLimit) {
+		if (pool == &gData.mPools[SUB_SHOT_BUCKET_ENEMY]) gData.mBudget.mStatistics.mRefusedAmount++;
+		return;
+	}
+	int index = pool->mAmount++;
 
 	SubShotAssignmentParseCaller assignmentCaller;
 	assignmentCaller.mActiveCaller = caller;
-	assignmentCaller.mActiveShot = e;
 	assignmentCaller.i = i;
 
-	Vector3D offset = getMugenAssignmentAsVector3DValueOrDefaultWhenEmpty(subShot->mOffset, &assignmentCaller, makePosition(0, 0, 0));
-	Vector3D velocity = makePosition(0, 0, 0);
-	assignmentCaller.mOffsetReference = &offset; // TODO: better
-
-	if (subShot->mHasAbsolutePosition) {
-		caller->mPosition = getMugenAssignmentAsVector3DValueOrDefaultWhenEmpty(subShot->mAbsolutePosition, &assignmentCaller, makePosition(0, 0, 0));
+	SubShotSpawn spawn;
+	subShot->mSpawn(&assignmentCaller, subShot, &spawn);
+	 
+	pool->mPositions[index] = vecAdd(caller->mPosition, spawn.mOffset);
+	pool->mVelocities[index] = spawn.mVelocity;
+	pool->mRotations[index] = spawn.mRotation;
+	pool->mTypes[index] = subShot;
+	pool->mFlags[index] = SUB_SHOT_FLAG_IS_STILL_ACTIVE;
+	pool->mSpawnFrames[index] = pool->mFrame;
+	if (subShot->mIsBallistic) {
+		pool->mFlags[index] |= SUB_SHOT_FLAG_IS_BALLISTIC;
+		setBallisticSubShotLifetime(pool, index);
 	}
 
-	double angle = 0;
-	if (subShot->mHasVelocity) {
-		velocity = getMugenAssignmentAsVector3DValueOrDefaultWhenEmpty(subShot->mVelocity, &assignmentCaller, makePosition(0, 0, 0));
-		angle = getAngleFromDirection(velocity);
+	pool->mCollisionData[index].mCollisionList = caller->mCollisionList;
+	pool->mCollisionData[index].mIsItem = 0;
+
+	if (!gData.mSpawnBudget && canSubShotDisplayBeDeferred(subShot)) {
+		pool->mFlags[index] |= SUB_SHOT_FLAG_IS_PENDING;
+		return;
 	}
-	
-	if (subShot->mHasAngle) {
-		angle = evaluateMugenAssignmentAndReturnAsFloat(subShot->mAngle, &assignmentCaller);
-		velocity = getDirectionFromAngleZ(angle);	
-		angle *= -1; // TODO: fix
+	gData.mSpawnBudget = max(0, gData.mSpawnBudget - 1);
+	loadSubShotDisplay(pool, index, &assignmentCaller);
+
+	if (subShot->mGimmick && subShot->mGimmick->mLoad) {
+		subShot->mGimmick->mLoad(pool, index);
 	}
+}
 
-	if (subShot->mHomingType == SHOT_TYPE_TARGET_RANDOM || subShot->mHomingType == SHOT_TYPE_TARGET_RANDOM_FINAL) {
-		Position p = vecAdd(caller->mPosition, offset);
-		Position enemyPos;
-		if (subShot->mHomingType == SHOT_TYPE_TARGET_RANDOM) {
-			enemyPos = getRandomEnemyOrBossPosition();
-		}
-		else {
-			enemyPos = getPlayerPosition();
-		}
-		
-		swap(&enemyPos.x, &p.x);
-		angle = getAngleFromDirection(vecSub(enemyPos, p));
-		velocity = getDirectionFromAngleZ(angle);
-		//offset = vecRotateZ(offset, angle);
-		angle *= -1; // TODO: fix
+static int isSubShotOffCenter(SubShotPool* pool, int i) {
+	double dx = pool->mPositions[i].x - 320;
+	double dy = pool->mPositions[i].y - 163;
+	return dx*dx + dy*dy > SHOT_BUDGET_OFF_CENTER_RADIUS * SHOT_BUDGET_OFF_CENTER_RADIUS;
+}
+
+static int isSubShotHidden(SubShotPool* pool, int i) {
+	// the play field ends at the UI bar, the margin keeps shots touching its edge
+	Position p = pool->mPositions[i];
+	return p.x < -SHOT_BUDGET_HIDDEN_MARGIN || p.x > 640 + SHOT_BUDGET_HIDDEN_MARGIN || p.y < -SHOT_BUDGET_HIDDEN_MARGIN || p.y > 327 + SHOT_BUDGET_HIDDEN_MARGIN;
+}
+
+static int getSubShotAgeBucket(SubShotPool* pool, int i) {
+	int age = pool->mFrame - pool->mSpawnFrames[i];
+	return min(SHOT_BUDGET_AGE_BUCKET_AMOUNT - 1, age / SHOT_BUDGET_AGE_BUCKET_SIZE);
+}
+
+typedef int(*SubShotRecycleFilter)(SubShotPool* pool, int i);
+
+static int isSubShotRecyclable(SubShotPool* pool, int i, SubShotRecycleFilter tFilter) {
+	if (pool->mFlags[i] & SUB_SHOT_FLAG_IS_UNLOADED) return 0;
+	return !tFilter || tFilter(pool, i);
+}
+
+static int recycleOldestSubShots(SubShotPool* pool, int tAmount, SubShotRecycleFilter tFilter) {
+	int histogram[SHOT_BUDGET_AGE_BUCKET_AMOUNT];
+	int i;
+	for (i = 0; i < SHOT_BUDGET_AGE_BUCKET_AMOUNT; i++) {
+		histogram[i] = 0;
 	}
-	
-	if (subShot->mHasSpeed) {
-		double speed = evaluateMugenAssignmentAndReturnAsFloat(subShot->mSpeed, &assignmentCaller);
-		velocity = vecScale(vecNormalize(velocity), speed);
+	for (i = 0; i < pool->mAmount; i++) {
+		if (!isSubShotRecyclable(pool, i, tFilter)) continue;
+		histogram[getSubShotAgeBucket(pool, i)]++;
 	}
-	 
-	e->mPhysicsID = addToPhysicsHandler(vecAdd(caller->mPosition, offset));
-	addAccelerationToHandledPhysics(e->mPhysicsID, velocity);
 
-	e->mCollider = makeColliderFromCirc(subShot->mColCirc);
+	int threshold = SHOT_BUDGET_AGE_BUCKET_AMOUNT - 1;
+	int olderAmount = 0;
+	while (threshold > 0 && olderAmount + histogram[threshold] < tAmount) {
+		olderAmount += histogram[threshold];
+		threshold--;
+	}
 
-	void(*hitCB)(void*, void*);
-	if (caller->mRoot->mCollisionData.mCollisionList == getEnemyCollisionList()) hitCB = finalBossShotHitCB;
-	else hitCB = shotHitCB;
+	int recycled = 0;
+	for (i = 0; i < pool->mAmount && recycled < tAmount; i++) {
+		if (!isSubShotRecyclable(pool, i, tFilter)) continue;
+		if (getSubShotAgeBucket(pool, i) < threshold) continue;
+		unloadSubShot(pool, i);
+		recycled++;
+	}
 
-	e->mCollisionID = addColliderToCollisionHandler(caller->mRoot->mCollisionData.mCollisionList, getHandledPhysicsPositionReference(e->mPhysicsID), e->mCollider, hitCB, e, &caller->mRoot->mCollisionData);
+	return recycled;
+}
 
-	double z;
-	if(caller->mRoot->mCollisionData.mCollisionList == getEnemyShotCollisionList()) z = 30;
-	else z = 25;
-	e->mAnimationID = addMugenAnimation(getMugenAnimation(&gData.mAnimations, subShot->mIdleAnimation), &gData.mSprites, makePosition(0, 0, z));
-	setMugenAnimationBasePosition(e->mAnimationID, getHandledPhysicsPositionReference(e->mPhysicsID));
+static void removeUnloadedSubShots(SubShotPool* pool) {
+	int i;
+	for (i = pool->mAmount - 1; i >= 0; i--) {
+		if (!(pool->mFlags[i] & SUB_SHOT_FLAG_IS_UNLOADED)) continue;
+		removeSubShot(pool, i);
+	}
+}
 
-	e->mRotation = getMugenAssignmentAsFloatValueOrDefaultWhenEmpty(subShot->mStartRotation, &assignmentCaller, angle);
-	setMugenAnimationDrawAngle(e->mAnimationID, e->mRotation);
+static void recycleSubShotsForVolley(SubShotPool* pool, int tAmount) {
+	int needed = min(tAmount, pool->mLimit) - (pool->mLimit - pool->mAmount);
+	int recycled = recycleOldestSubShots(pool, needed, isSubShotOffCenter);
+	if (recycled < needed) {
+		recycled += recycleOldestSubShots(pool, needed - recycled, NULL);
+	}
+	removeUnloadedSubShots(pool);
+	gData.mBudget.mStatistics.mRecycledAmount += recycled;
+}
 
-	setShotColor(subShot, e, &assignmentCaller);
+static void updateSubShotReservation() {
+	ShotBudget* budget = &gData.mBudget;
+	if (!budget->mReservedAmount) return;
 
-	e->mHasGimmickData = 0;
-	e->mIsStillActive = 1;
+	SubShotPool* pool = &gData.mPools[SUB_SHOT_BUCKET_ENEMY];
+	int needed = budget->mReservedAmount - (pool->mLimit - pool->mAmount);
+	if (needed <= 0) return;
 
-	caller->mRoot->mSubShotsLeft++;
-	e->mListID = int_map_push_back_owned(&caller->mRoot->mSubShots, e);
+	// only shots hidden below the UI or past the screen edges, so no visible bullet vanishes under any policy
+	int recycled = recycleOldestSubShots(pool, min(needed, SUB_SHOT_RESERVATION_RECYCLE_PER_FRAME), isSubShotHidden);
+	removeUnloadedSubShots(pool);
+	budget->mStatistics.mRecycledAmount += recycled;
+}
+
+static int isSubShotThinnedOut(int i) {
+	return gData.mBudget.mThinningFactor > 1 && (i % gData.mBudget.mThinningFactor);
 }
 
 static void addSubShot(void* tCaller, void* tData) {
 	SubShotCaller* caller = tCaller;
 	SubShotType* subShot = tData;
 
-	int amount = getMugenAssignmentAsIntegerValueOrDefaultWhenEmpty(subShot->mAmount, NULL, 1);
+	int amount = getCompiledAssignmentAsIntegerValueOrDefaultWhenEmpty(subShot->mAmount, NULL, 1);
+	SubShotPool* pool = getSubShotPoolForCollisionList(caller->mCollisionList);
+	int isOverBudget = pool == &gData.mPools[SUB_SHOT_BUCKET_ENEMY] && pool->mAmount + amount > pool->mLimit;
+	if (isOverBudget) {
+		gData.mBudget.mStatistics.mExceededAmount++;
+		if (gData.mBudget.mPolicy == SHOT_BUDGET_POLICY_RECYCLE) {
+			recycleSubShotsForVolley(pool, amount);
+		}
+	}
+	int isThinning = isOverBudget && gData.mBudget.mPolicy == SHOT_BUDGET_POLICY_THIN;
+
 	int i;
 	for (i = 0; i < amount; i++) {
+		if (isThinning && isSubShotThinnedOut(i)) {
+			gData.mBudget.mStatistics.mThinnedAmount++;
+			continue;
+		}
 		addSingleSubShot(caller, subShot, i);
 	}
 }
 
 void addShot(int tID, int tCollisionList, Position tPosition)
 {
-	ActiveShot* e = allocMemory(sizeof(ActiveShot));
 	assert(int_map_contains(&gData.mShotTypes, tID));
-	e->mType = int_map_get(&gData.mShotTypes, tID);
-	e->mCollisionData.mCollisionList = tCollisionList;
-	e->mCollisionData.mIsItem = 0;
-	e->mSubShotsLeft = 0;
-	e->mSubShots = new_int_map();
-	int_map_push_back_owned(&gData.mActiveShots, e);
+	ShotType* type = int_map_get(&gData.mShotTypes, tID);
 
 	SubShotCaller caller;
-	caller.mRoot = e;
+	caller.mCollisionList = tCollisionList;
 	caller.mPosition = tPosition;
-	int_map_map(&e->mType->mSubShots, addSubShot, &caller);
-}
-
-typedef struct {
-	int mCollisionList;
-} RemoveShotsForSingleListCaller;
-
-static int removeShotTypeForSingleSubShot(void* tCaller, void* tData) {
-	(void)tCaller;
-	ActiveSubShot* e = tData;
-	unloadSubShot(e);
-	return 1;
+	int_map_map(&type->mSubShots, addSubShot, &caller);
 }
 
-static void removeShotTypeForSingleShot(void* tCaller, void* tData) {
-	ActiveShot* e = tData;
-	RemoveShotsForSingleListCaller* caller = tCaller;
-	if (caller->mCollisionList != e->mCollisionData.mCollisionList) return;
-
-	int_map_remove_predicate(&e->mSubShots, removeShotTypeForSingleSubShot, NULL);
+static void clearSubShotPool(SubShotPool* pool) {
+	int i;
+	for (i = 0; i < pool->mAmount; i++) {
+		unloadSubShot(pool, i);
+	}
+	pool->mAmount = 0;
 }
 
 void removeEnemyShots()
 {
-	RemoveShotsForSingleListCaller caller;
-	caller.mCollisionList = getEnemyShotCollisionList();
-	int_map_map(&gData.mActiveShots, removeShotTypeForSingleShot, &caller);
+	clearSubShotPool(&gData.mPools[SUB_SHOT_BUCKET_ENEMY]);
 }
 
-typedef struct {
-	Position mTarget;
-	int mState;
-} BigBangData;
+void convertEnemyShotsToItems()
+{
+	SubShotPool* pool = &gData.mPools[SUB_SHOT_BUCKET_ENEMY];
+
+	// sampled, so a full screen of bullets does not turn into a full screen of items
+	int stride = max(1, (pool->mAmount + SHOT_CONVERSION_MAX_ITEM_AMOUNT - 1) / SHOT_CONVERSION_MAX_ITEM_AMOUNT);
+	int i;
+	for (i = 0; i < pool->mAmount; i += stride) {
+		if (pool->mFlags[i] & SUB_SHOT_FLAG_IS_UNLOADED) continue;
+		addSmallPowerItems(pool->mPositions[i], 1);
+	}
+
+	clearSubShotPool(pool);
+}
 
 static void bangOut(BigBangData* data) {
 	int side = randfromInteger(0, 3);
@@ -600,25 +1520,15 @@ static void bangIn(BigBangData* data) {
 	data->mState = 1;
 }
 
-static void loadBigBang(ActiveSubShot* e) {
-	e->mGimmickData = allocMemory(sizeof(BigBangData));
-	e->mHasGimmickData = 1;
-
-	BigBangData* data = e->mGimmickData;
+static void loadBigBangGimmick(SubShotPool* pool, int i) {
+	BigBangData* data = &pool->mGimmickData[i].mBigBang;
 	bangOut(data);
 }
 
-void evaluateBigBangFunction(char * tDst, void * tCaller)
-{
-	ActiveSubShot* e = tCaller;
-
-	if (!e->mHasGimmickData) {
-		loadBigBang(e);
-	}
-	
-	BigBangData* data = e->mGimmickData;
-	Position pos = *getHandledPhysicsPositionReference(e->mPhysicsID);
-	Vector3D* vel = getHandledPhysicsVelocityReference(e->mPhysicsID);
+static void updateBigBangGimmick(SubShotPool* pool, int i) {
+	BigBangData* data = &pool->mGimmickData[i].mBigBang;
+	Position pos = pool->mPositions[i];
+	Vector3D* vel = &pool->mVelocities[i];
 	
 	Vector3D delta = vecSub(data->mTarget, pos);
 	double l = vecLength(delta);
@@ -628,46 +1538,24 @@ void evaluateBigBangFunction(char * tDst, void * tCaller)
 	}
 		
 	*vel = vecScale(vecNormalize(delta), 2);
-	
-	strcpy(tDst, "");
 }
 
-void evaluateBounceFunction(char * tDst, void * tCaller)
-{
-	ActiveSubShot* e = tCaller;
-	Position pos = *getHandledPhysicsPositionReference(e->mPhysicsID);
-	Velocity* vel = getHandledPhysicsVelocityReference(e->mPhysicsID);
+static void updateBounceGimmick(SubShotPool* pool, int i) {
+	Position pos = pool->mPositions[i];
+	Velocity* vel = &pool->mVelocities[i];
 
 	if (pos.x < 0) vel->x = 1;
 	if (pos.x > 640) vel->x = -1;
-
-	strcpy(tDst, "");
 }
 
-typedef struct {
-
-	Velocity mDirection;
-	double mState;
-	int mIsActive;
-} AckermannData;
-
-static void initAckermann(ActiveSubShot* e) {
-	e->mGimmickData = allocMemory(sizeof(AckermannData));
-	e->mHasGimmickData = 1;
-
-	AckermannData* data = e->mGimmickData;
+static void loadAckermannGimmick(SubShotPool* pool, int i) {
+	AckermannData* data = &pool->mGimmickData[i].mAckermann;
 	data->mIsActive = 0;
 }
 
-void evaluateAckermannFunction(char * tDst, void * tCaller)
-{
-	ActiveSubShot* e = tCaller;
-	if (!e->mHasGimmickData) {
-		initAckermann(e);
-	}
-
-	Velocity* vel = getHandledPhysicsVelocityReference(e->mPhysicsID);
-	AckermannData* data = e->mGimmickData;
+static void updateAckermannGimmick(SubShotPool* pool, int i) {
+	Velocity* vel = &pool->mVelocities[i];
+	AckermannData* data = &pool->mGimmickData[i].mAckermann;
 	if (!data->mIsActive) {
 		if (vecLength(*vel) > 0 && randfrom(0, 1) < 0.005) {
 			data->mIsActive = 1;
@@ -679,66 +1567,177 @@ void evaluateAckermannFunction(char * tDst, void * tCaller)
 		data->mState = min(data->mState + 1 / 60.0, 1);
 		*vel = vecRotateZ(data->mDirection, 2*M_PI*data->mState);
 		double angle = getAngleFromDirection(*vel);
-		setMugenAnimationDrawAngle(e->mAnimationID, angle);
+		setMugenAnimationDrawAngle(pool->mAnimationIDs[i], angle);
 	}
-
-	strcpy(tDst, "");
 }
 
-void evaluateSwirlFunction(char * tDst, void * tCaller)
-{
-	ActiveSubShot* e = tCaller;
-	Velocity* vel = getHandledPhysicsVelocityReference(e->mPhysicsID);
+static void updateSwirlGimmick(SubShotPool* pool, int i) {
+	Velocity* vel = &pool->mVelocities[i];
 	*vel = vecRotateZ(*vel, 0.01);
 	double angle = getAngleFromDirection(*vel);
-	setMugenAnimationDrawAngle(e->mAnimationID, angle);
-
-	strcpy(tDst, "");
+	setMugenAnimationDrawAngle(pool->mAnimationIDs[i], angle);
 }
 
-void evaluateBlamFunction(char * tDst, void * tCaller)
-{
-
-	ActiveSubShot* e = tCaller;
-	Velocity* vel = getHandledPhysicsVelocityReference(e->mPhysicsID);
+static void updateBlamGimmick(SubShotPool* pool, int i) {
+	Velocity* vel = &pool->mVelocities[i];
 	
 	double l = vecLength(*vel);
 	if (l > 0) {
 		*vel = vecScale(vecNormalize(*vel), min(l*1.1, 20));
 	}
+}
 
-	strcpy(tDst, "");
+static void loadTransienceGimmick(SubShotPool* pool, int i) {
+	TransienceData* data = &pool->mGimmickData[i].mTransience;
+	data->mNow = 0;
 }
 
+static void updateTransienceGimmick(SubShotPool* pool, int i) {
+	TransienceData* data = &pool->mGimmickData[i].mTransience;
 
-typedef struct {
-	Duration mNow;	
-} TransienceData;
+	if (handleDurationAndCheckIfOver(&data->mNow, 60)) {
+		pool->mFlags[i] &= ~SUB_SHOT_FLAG_IS_STILL_ACTIVE;
+	}
+}
 
-static void initTransience(ActiveSubShot* e) {
-	e->mGimmickData = allocMemory(sizeof(TransienceData));
-	e->mHasGimmickData = 1;
+static ShotGimmick gShotGimmicks[] = {
+	{ "bigbang", SHOT_GIMMICK_BIG_BANG, loadBigBangGimmick, updateBigBangGimmick },
+	{ "bounce", SHOT_GIMMICK_BOUNCE, NULL, updateBounceGimmick },
+	{ "ackermann", SHOT_GIMMICK_ACKERMANN, loadAckermannGimmick, updateAckermannGimmick },
+	{ "groovy", SHOT_GIMMICK_GROOVY, NULL, updateSwirlGimmick },
+	{ "blam", SHOT_GIMMICK_BLAM, NULL, updateBlamGimmick },
+	{ "transience", SHOT_GIMMICK_TRANSIENCE, loadTransienceGimmick, updateTransienceGimmick },
+};
 
-	TransienceData* data = e->mGimmickData;
-	data->mNow = 0;
+static int getShotGimmickIndex(ShotGimmick* tGimmick) {
+	if (!tGimmick) return -1;
+	return (int)(tGimmick - gShotGimmicks);
+}
+
+static ShotGimmick* getShotGimmickFromIndex(int tIndex) {
+	if (tIndex < 0 || tIndex >= (int)(sizeof(gShotGimmicks) / sizeof(gShotGimmicks[0]))) return NULL;
+	return &gShotGimmicks[tIndex];
 }
 
-void evaluateTransienceFunction(char * tDst, void * tCaller)
+static void parseGimmick(SubShotType* e, MugenDefScriptGroup* tGroup) {
+	e->mGimmick = NULL;
+	if (!string_map_contains(&tGroup->mElements, "gimmick")) return;
+
+	char* text = getAllocatedMugenDefStringVariableAsGroup(tGroup, "gimmick");
+	int i;
+	for (i = 0; i < (int)(sizeof(gShotGimmicks) / sizeof(gShotGimmicks[0])); i++) {
+		if (!strcmp(gShotGimmicks[i].mName, text)) {
+			e->mGimmick = &gShotGimmicks[i];
+			break;
+		}
+	}
+
+	if (!e->mGimmick && strcmp("", text)) {
+		logError("Unrecognized gimmick");
+		logErrorString(text);
+		abortSystem();
+	}
+
+	freeMemory(text);
+}
+
+void startBombField(Position* tCenterReference)
 {
-	ActiveSubShot* e = tCaller;
-	if (!e->mHasGimmickData) {
-		initTransience(e);
+	BombField* e = &gData.mBombField;
+	if (!e->mIsActive) {
+		// the big round bullet is a centered disc, so scaling it by its own radius draws the targeted circle
+		MugenAnimation* animation = getMugenAnimation(&gData.mAnimations, BOMB_FIELD_ANIMATION);
+		Vector3DI size = getAnimationFirstElementSpriteSize(animation, &gData.mSprites);
+		e->mSpriteRadius = max(1, size.x) / 2.0;
+		e->mAnimationID = addMugenAnimation(animation, &gData.mSprites, makePosition(0, 0, 12));
+		setMugenAnimationTransparency(e->mAnimationID, 0.5);
 	}
-	TransienceData* data = e->mGimmickData;
 
-	if (handleDurationAndCheckIfOver(&data->mNow, 60)) {
-		e->mIsStillActive = 0;
+	e->mCenterReference = tCenterReference;
+	setMugenAnimationBasePosition(e->mAnimationID, e->mCenterReference);
+	e->mRadius = 0;
+	e->mFrame = 0;
+	e->mIsActive = 1;
+}
+
+void stopBombField()
+{
+	BombField* e = &gData.mBombField;
+	if (!e->mIsActive) return;
+
+	removeMugenAnimation(e->mAnimationID);
+	e->mIsActive = 0;
+}
+
+static void damageRandomTargetInBombField(Position tCenter, double tRadius) {
+	// one hit per frame on a random target, like the targetrandom volley the field replaced
+	int enemyAmount = getEnemyAmountInCircle(tCenter, tRadius);
+	int targetAmount = enemyAmount + isBossInCircle(tCenter, tRadius);
+	if (!targetAmount) return;
+
+	int target = randfromInteger(0, targetAmount - 1);
+	if (target < enemyAmount) damageEnemyInCircle(tCenter, tRadius, target);
+	else damageBossInCircle(tCenter, tRadius);
+}
+
+static void updateBombField() {
+	BombField* e = &gData.mBombField;
+	if (!e->mIsActive) return;
+
+	e->mRadius = min(BOMB_FIELD_MAX_RADIUS, e->mRadius + BOMB_FIELD_GROWTH_PER_FRAME);
+	double scale = e->mRadius / e->mSpriteRadius;
+	setMugenAnimationDrawScale(e->mAnimationID, makePosition(scale, scale, 1));
+	if (!(e->mFrame++ % BOMB_FIELD_COLOR_INTERVAL)) {
+		setRainbowShotColor(e->mAnimationID);
 	}
 
-	strcpy(tDst, "");
+	damageRandomTargetInBombField(*e->mCenterReference, e->mRadius);
 }
 
 int getFinalBossShotsDeflected()
 {
 	return gData.mFinalBossShotsDeflected;
 }
+
+static void addSubShotAmountEstimate(void* tCaller, void* tData) {
+	int* amount = tCaller;
+	SubShotType* subShot = tData;
+	*amount += getCompiledAssignmentAsIntegerValueOrDefaultWhenEmpty(subShot->mAmount, NULL, 1);
+}
+
+int getShotSubShotAmountEstimate(int tID)
+{
+	if (!int_map_contains(&gData.mShotTypes, tID)) return 0;
+	ShotType* type = int_map_get(&gData.mShotTypes, tID);
+
+	int amount = 0;
+	int_map_map(&type->mSubShots, addSubShotAmountEstimate, &amount);
+	return amount;
+}
+
+void reserveEnemySubShots(int tAmount)
+{
+	gData.mBudget.mReservedAmount = max(0, min(gData.mBudget.mAmount, tAmount));
+}
+
+void setShotBudget(int tAmount, ShotBudgetPolicy tPolicy, int tThinningFactor)
+{
+	gData.mBudget.mAmount = max(0, min(MAX_ENEMY_SUB_SHOT_AMOUNT, tAmount));
+	gData.mBudget.mPolicy = tPolicy;
+	gData.mBudget.mThinningFactor = max(1, tThinningFactor);
+	gData.mBudget.mReservedAmount = 0;
+	gData.mPools[SUB_SHOT_BUCKET_ENEMY].mLimit = gData.mBudget.mAmount;
+}
+
+ShotBudgetStatistics getShotBudgetStatistics()
+{
+	return gData.mBudget.mStatistics;
+}
+
+void resetShotBudgetStatistics()
+{
+	gData.mBudget.mStatistics.mExceededAmount = 0;
+	gData.mBudget.mStatistics.mRefusedAmount = 0;
+	gData.mBudget.mStatistics.mRecycledAmount = 0;
+	gData.mBudget.mStatistics.mThinnedAmount = 0;
+}
@@ -4,19 +4,37 @@
 #include <tari/actorhandler.h>
 #include <tari/physics.h>
 
+typedef enum {
+	SHOT_BUDGET_POLICY_REFUSE,
+	SHOT_BUDGET_POLICY_RECYCLE,
+	SHOT_BUDGET_POLICY_THIN,
+} ShotBudgetPolicy;
+
+typedef struct {
+	int mExceededAmount;
+	int mRefusedAmount;
+	int mRecycledAmount;
+	int mThinnedAmount;
+} ShotBudgetStatistics;
+
 void getShotAngleTowardsPlayer(char* tOutput, void* tCaller);
+double getShotAngleTowardsPlayerValue(void* tCaller);
 
 void getCurrentSubShotIndex(char* tOutput, void* tCaller);
+double getCurrentSubShotIndexValue(void* tCaller);
 void addShot(int tID, int tCollisionList, Position tPosition);
 void removeEnemyShots();
-void evaluateBigBangFunction(char* tDst, void* tCaller);
-void evaluateBounceFunction(char* tDst, void* tCaller);
+void convertEnemyShotsToItems();
+void startBombField(Position* tCenterReference);
+void stopBombField();
 void evaluateTextAidFunction(char* tDst, void* tCaller);
-void evaluateAckermannFunction(char* tDst, void* tCaller);
-void evaluateSwirlFunction(char* tDst, void* tCaller);
-void evaluateBlamFunction(char* tDst, void* tCaller);
-void evaluateTransienceFunction(char* tDst, void* tCaller);
 
 int getFinalBossShotsDeflected();
 
+void setShotBudget(int tAmount, ShotBudgetPolicy tPolicy, int tThinningFactor);
+int getShotSubShotAmountEstimate(int tID);
+void reserveEnemySubShots(int tAmount);
+ShotBudgetStatistics getShotBudgetStatistics();
+void resetShotBudgetStatistics();
+
 extern ActorBlueprint ShotHandler;
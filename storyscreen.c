@@ -15,6 +15,7 @@
 #include <tari/mugenanimationhandler.h>
 
 #include "titlescreen.h"
+#include "assetregistry.h"
 
 
 static struct {
@@ -165,6 +166,7 @@ static void findStartOfStoryBoard() {
 
 
 static void loadStoryScreen() {
+	resetAssetRegistry();
 	gData.mIsStoryOver = 0;
 	
 	instantiateActor(getMugenAnimationHandlerActorBlueprint());
@@ -172,7 +174,7 @@ static void loadStoryScreen() {
 	gData.mScript = loadMugenDefScript(gData.mDefinitionPath);
 
 	char* spritePath = getAllocatedMugenDefStringVariable(&gData.mScript, "Header", "sprites");
-	gData.mSprites = loadMugenSpriteFileWithoutPalette(spritePath);
+	gData.mSprites = acquireMugenSpriteFileWithoutPalette(spritePath);
 	freeMemory(spritePath);
 
 	findStartOfStoryBoard();
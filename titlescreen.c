@@ -8,6 +8,7 @@
 #include "bg.h"
 #include "level.h"
 #include "player.h"
+#include "assetregistry.h"
 
 static struct {
 	MugenSpriteFile mSprites;
@@ -17,9 +18,10 @@ static struct {
 } gData;
 
 static void loadTitleScreen() {
+	resetAssetRegistry();
 	instantiateActor(getMugenAnimationHandlerActorBlueprint());
 	
-	gData.mSprites = loadMugenSpriteFileWithoutPalette("assets/title/TITLE.sff");
+	gData.mSprites = acquireMugenSpriteFileWithoutPalette("assets/title/TITLE.sff");
 	 
 	gData.mTitleAnimation = createOneFrameMugenAnimationForSprite(1, 0);
 	gData.mTitleAnimationID = addMugenAnimation(gData.mTitleAnimation, &gData.mSprites, makePosition(0, 0, 10));
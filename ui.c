@@ -5,6 +5,8 @@
 #include <tari/math.h>
 #include <tari/mugenanimationhandler.h>
 
+#include "assetregistry.h"
+
 static struct {
 	MugenSpriteFile mSprites;
 	MugenAnimation* mAnimation;
@@ -21,7 +23,7 @@ static struct {
 static void loadUserInterface(void* tData) {
 	(void)tData;
 	
-	gData.mSprites = loadMugenSpriteFileWithoutPalette("assets/ui/UI.sff");
+	gData.mSprites = acquireMugenSpriteFileWithoutPalette("assets/ui/UI.sff");
 	gData.mAnimation = createOneFrameMugenAnimationForSprite(0, 0);
 
 	gData.mAnimationID = addMugenAnimation(gData.mAnimation, &gData.mSprites, makePosition(0, 327, 40));
@@ -41,6 +43,11 @@ void loadStageDisplay(MugenSpriteFile * tSprites)
 	gData.mStageDisplayAnimationID = addMugenAnimation(gData.mStageDisplayAnimation, tSprites, makePosition(15, 327+29, 45));
 }
 
+void unloadStageDisplay()
+{
+	removeMugenAnimation(gData.mStageDisplayAnimationID);
+}
+
 void setPowerText(int tPower)
 {
 	int decimal = tPower / 100;
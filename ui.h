@@ -6,6 +6,7 @@
 extern ActorBlueprint UserInterface;
 
 void loadStageDisplay(MugenSpriteFile* mSprites);
+void unloadStageDisplay();
 void setPowerText(int tPower);
 void setLifeText(int tLifeAmount);
 void setBombText(int tBombAmount);
\ No newline at end of file